@@ -27,11 +27,6 @@ CPMAddPackage(
   OPTIONS "NOISY_LOGGING OFF" "BUILD_SHARED_LIBS OFF"
   FIND_PACKAGE_ARGUMENTS NAME WOFF2
 )
-CPMAddPackage(
-  URI "gh:InCom-0/base64#master"
-  OPTIONS "BASE64_ENABLE_TESTING OFF"
-  NAME base64tl
-)
 
 
 
@@ -50,7 +45,3 @@ endif()
 if(woff2_ADDED)
   set(OTFCCXX_WOFF2_BUILDFROMSOURCE TRUE)
 endif()
-
-if(base64tl_ADDED)
-  set(OTFCCXX_BASE64TL_BUILDFROMSOURCE TRUE)
-endif()
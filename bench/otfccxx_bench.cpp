@@ -0,0 +1,583 @@
+// Self-contained benchmark suite for otfccxx.
+//
+// Usage: otfccxx_bench [--font <path>]... [--iterations <n>] [--filter <substring>] [--out <file.json>]
+//                      [--trace <file.json>] [--metrics <file.prom>]
+//                      [--alloc-budget <file>] [--alloc-record <file>]
+//
+// Results are emitted as JSON (stdout unless --out is given). Every case reports wall time statistics, throughput and
+// the peak resident set size of the process after the case ran, so that runs of different releases can be diffed.
+// Font cases always run on fonts generated by otfccxx::FontSynthesizer (latin, CJK sized and deep composite chains),
+// and additionally on every font given by --font or OTFCCXX_BENCH_FONT.
+// --trace records the library's internal stages of all iterations as Chrome trace-event JSON, --metrics dumps the
+// library's metrics registry in Prometheus text format at the end of the run.
+//
+// With a library built with otfccxx_ALLOC_ACCOUNTING every case also reports its heap allocations per iteration.
+// --alloc-record writes them as a budget file ('<case name> <max allocations>' per line), --alloc-budget checks a run
+// against such a file and exits with 3 when any case allocates more than its budget. Asking for either without
+// accounting compiled in exits with 4. Only the allocations of the thread running the case are counted, so cases that
+// spread their work over several threads report a lower bound and are left out of the budget. bench/alloc_budget.txt
+// is the committed budget, the 'otfccxx_allocBudget' CTest test checks it.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace {
+using namespace std::literals;
+
+// #####################################################################
+// ### Harness ###
+// #####################################################################
+
+uint64_t
+peak_rss_bytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc{};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) { return pmc.PeakWorkingSetSize; }
+    return 0;
+#else
+    rusage ru{};
+    if (getrusage(RUSAGE_SELF, &ru) != 0) { return 0; }
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(ru.ru_maxrss);
+#else
+    return static_cast<uint64_t>(ru.ru_maxrss) * 1024u;
+#endif
+#endif
+}
+
+std::string
+json_escape(std::string_view sv) {
+    std::string res;
+    res.reserve(sv.size());
+    for (char const c : sv) {
+        if (c == '"' || c == '\\') { res.push_back('\\'); }
+        if (static_cast<unsigned char>(c) < 0x20) { res += std::format("\\u{:04x}", static_cast<unsigned char>(c)); }
+        else { res.push_back(c); }
+    }
+    return res;
+}
+
+enum class unit {
+    bytes,
+    codepoints,
+};
+
+struct CaseResult {
+    std::string         name;
+    std::string         skipReason;
+    std::vector<double> wallSeconds;
+    uint64_t            itemsPerIteration = 0;
+    unit                itemUnit          = unit::bytes;
+    uint64_t            peakRSS           = 0;
+    otfccxx::AllocStats allocsPerIteration;
+    bool                multiThreaded     = false; // 'allocsPerIteration' misses the other threads
+};
+
+// One iteration returns the number of items (bytes or codepoints) processed, or std::nullopt on failure
+using CaseFn = std::function<std::optional<uint64_t>()>;
+
+struct Config {
+    std::vector<std::string> fontPaths;
+    size_t                   iterations = 10;
+    std::string              filter;
+    std::string              outPath;
+    std::string              tracePath;
+    std::string              metricsPath;
+    std::string              allocBudgetPath;
+    std::string              allocRecordPath;
+};
+
+class Runner {
+public:
+    explicit Runner(Config const &cfg) : cfg_(cfg) {}
+
+    void
+    run(std::string name, unit u, CaseFn const &fn, bool const multiThreaded = false) {
+        if (not cfg_.filter.empty() && name.find(cfg_.filter) == std::string::npos) { return; }
+
+        CaseResult res{.name = std::move(name), .itemUnit = u, .multiThreaded = multiThreaded};
+        std::cerr << "[otfccxx_bench] " << res.name << '\n';
+
+        // Warm-up, also validates the case
+        if (auto exp_items = fn(); not exp_items.has_value()) { res.skipReason = "case failed"; }
+        else {
+            res.itemsPerIteration = exp_items.value();
+            for (size_t i = 0; i < cfg_.iterations; ++i) {
+                auto const allocsBeg = otfccxx::alloc_threadTotals();
+                auto const beg       = std::chrono::steady_clock::now();
+                auto const r         = fn();
+                auto const end       = std::chrono::steady_clock::now();
+                auto const allocsEnd = otfccxx::alloc_threadTotals();
+                if (not r.has_value()) {
+                    res.skipReason = "case failed";
+                    break;
+                }
+                res.wallSeconds.push_back(std::chrono::duration<double>(end - beg).count());
+
+                // Steady state, ie. the last iteration wins
+                res.allocsPerIteration = {allocsEnd.allocations - allocsBeg.allocations,
+                                          allocsEnd.bytes - allocsBeg.bytes};
+            }
+        }
+        res.peakRSS = peak_rss_bytes();
+        results_.push_back(std::move(res));
+    }
+
+    void
+    skip(std::string name, std::string reason) {
+        if (not cfg_.filter.empty() && name.find(cfg_.filter) == std::string::npos) { return; }
+        results_.push_back(CaseResult{.name = std::move(name), .skipReason = std::move(reason)});
+    }
+
+    std::string
+    to_json() const {
+        std::string out = "{\n  \"suite\": \"otfccxx_bench\",\n";
+        out += std::format("  \"iterations\": {},\n  \"cases\": [\n", cfg_.iterations);
+
+        for (size_t i = 0; i < results_.size(); ++i) {
+            auto const &r = results_[i];
+            out += std::format("    {{\"name\": \"{}\"", json_escape(r.name));
+
+            if (not r.skipReason.empty()) { out += std::format(", \"skipped\": \"{}\"", json_escape(r.skipReason)); }
+            else {
+                auto sorted = r.wallSeconds;
+                std::ranges::sort(sorted);
+                double const median = sorted[sorted.size() / 2];
+                double const mean   = std::accumulate(sorted.begin(), sorted.end(), 0.0) / sorted.size();
+
+                out += std::format(", \"wall_s\": {{\"min\": {:.9f}, \"median\": {:.9f}, \"mean\": {:.9f}, "
+                                   "\"max\": {:.9f}}}",
+                                   sorted.front(), median, mean, sorted.back());
+                if (r.itemUnit == unit::bytes) {
+                    out += std::format(", \"throughput_MBps\": {:.3f}",
+                                       static_cast<double>(r.itemsPerIteration) / median / 1.0e6);
+                }
+                else {
+                    out += std::format(", \"throughput_codepoints_per_s\": {:.1f}",
+                                       static_cast<double>(r.itemsPerIteration) / median);
+                }
+                out += std::format(", \"items_per_iteration\": {}", r.itemsPerIteration);
+                if (otfccxx::alloc_accountingEnabled()) {
+                    out += std::format(", \"allocs_per_iteration\": {}, \"alloc_bytes_per_iteration\": {}",
+                                       r.allocsPerIteration.allocations, r.allocsPerIteration.bytes);
+                    if (r.multiThreaded) { out += ", \"allocs_calling_thread_only\": true"; }
+                }
+            }
+            out += std::format(", \"peak_rss_bytes\": {}}}{}\n", r.peakRSS, i + 1 == results_.size() ? "" : ",");
+        }
+        out += "  ]\n}\n";
+        return out;
+    }
+
+    // '<case name> <max allocations>' per line
+    std::string
+    to_allocBudget() const {
+        std::string out = "# otfccxx_bench allocation budget, allocations per iteration\n";
+        for (auto const &r : results_) {
+            if (r.skipReason.empty() && not r.multiThreaded) {
+                out += std::format("{} {}\n", r.name, r.allocsPerIteration.allocations);
+            }
+        }
+        return out;
+    }
+
+    // Returns the violations, cases missing from the budget or from this run are ignored
+    std::vector<std::string>
+    check_allocBudget(std::string_view budget) const {
+        std::vector<std::string> res;
+        for (auto const lineRng : std::views::split(budget, '\n')) {
+            std::string_view const line(lineRng.begin(), lineRng.end());
+            if (line.empty() || line.front() == '#') { continue; }
+
+            size_t const sep = line.rfind(' ');
+            if (sep == std::string_view::npos) { continue; }
+            std::string_view const name  = line.substr(0, sep);
+            uint64_t const         limit = std::strtoull(std::string(line.substr(sep + 1)).c_str(), nullptr, 10);
+
+            auto const found = std::ranges::find(results_, name, &CaseResult::name);
+            if (found == results_.end() || not found->skipReason.empty() || found->multiThreaded) { continue; }
+            if (found->allocsPerIteration.allocations > limit) {
+                res.push_back(std::format("{}: {} allocations, budget {}", found->name,
+                                          found->allocsPerIteration.allocations, limit));
+            }
+        }
+        return res;
+    }
+
+private:
+    Config const           &cfg_;
+    std::vector<CaseResult> results_;
+};
+
+
+// #####################################################################
+// ### Inputs ###
+// #####################################################################
+
+otfccxx::Bytes
+random_bytes(size_t n, uint32_t seed) {
+    std::mt19937   rng(seed);
+    otfccxx::Bytes res(n);
+    for (auto &b : res) { b = static_cast<std::byte>(rng()); }
+    return res;
+}
+
+std::vector<uint32_t>
+cps_range(uint32_t first, uint32_t last) {
+    std::vector<uint32_t> res(last - first + 1);
+    std::iota(res.begin(), res.end(), first);
+    return res;
+}
+
+// About 'approxBytes' of UTF-8 text cycling through 'cps' (surrogates are skipped)
+std::string
+utf8_text(std::vector<uint32_t> const &cps, size_t approxBytes) {
+    std::string res;
+    res.reserve(approxBytes + 4);
+    while (res.size() < approxBytes) {
+        for (uint32_t const cp : cps) {
+            if (cp < 0x80) { res += static_cast<char>(cp); }
+            else if (cp < 0x800) {
+                res += static_cast<char>(0xC0 | (cp >> 6));
+                res += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            else if (cp < 0xD800 || (cp > 0xDFFF && cp < 0x10000)) {
+                res += static_cast<char>(0xE0 | (cp >> 12));
+                res += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+                res += static_cast<char>(0x80 | (cp & 0x3F));
+            }
+            if (res.size() >= approxBytes) { break; }
+        }
+    }
+    return res;
+}
+
+
+// #####################################################################
+// ### Cases ###
+// #####################################################################
+
+void
+bench_base64(Runner &rn) {
+    for (size_t const sz : {size_t{64} * 1024, size_t{4} * 1024 * 1024}) {
+        auto const  data = random_bytes(sz, 7);
+        std::string encoded;
+
+        rn.run(std::format("base64.encode.{}KiB", sz / 1024), unit::bytes, [&]() -> std::optional<uint64_t> {
+            auto exp_res = otfccxx::Converter::encode_base64(data);
+            if (not exp_res.has_value()) { return std::nullopt; }
+            encoded = std::move(exp_res.value());
+            return data.size();
+        });
+        rn.run(std::format("base64.decode.{}KiB", sz / 1024), unit::bytes, [&]() -> std::optional<uint64_t> {
+            auto exp_res = otfccxx::Converter::decode_base64(encoded);
+            if (not exp_res.has_value()) { return std::nullopt; }
+            return encoded.size();
+        });
+        rn.run(std::format("base64.dataURI.{}KiB", sz / 1024), unit::bytes, [&]() -> std::optional<uint64_t> {
+            auto exp_res = otfccxx::Converter::encode_dataURI(data);
+            if (not exp_res.has_value()) { return std::nullopt; }
+            return data.size();
+        });
+    }
+}
+
+void
+bench_font(Runner &rn, std::string const &tag, otfccxx::FontSource const &src) {
+    auto const font = src.bytes();
+
+    // WOFF2
+    otfccxx::Bytes woff2;
+    rn.run(std::format("woff2.encode.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+        auto exp_res = otfccxx::Converter::encode_Woff2(font);
+        if (not exp_res.has_value()) { return std::nullopt; }
+        woff2 = std::move(exp_res.value());
+        return font.size();
+    });
+    rn.run(std::format("woff2.decode.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+        if (woff2.empty()) { return std::nullopt; }
+        auto exp_res = otfccxx::Converter::decode_Woff2(woff2);
+        if (not exp_res.has_value()) { return std::nullopt; }
+        return exp_res->size();
+    });
+
+    // Subsetter
+    auto const subset = [&](std::vector<uint32_t> const &cps, size_t faces) -> std::optional<uint64_t> {
+        otfccxx::Subsetter subs;
+        for (size_t i = 0; i < faces; ++i) { subs.add_ff_toSubset(src); }
+        subs.add_toKeep_CPs(cps);
+        if (auto exp_res = subs.execute_bestEffort(); not exp_res.has_value()) { return std::nullopt; }
+        return cps.size();
+    };
+    auto const smallCPs = cps_range(0x20, 0x7E);
+    auto const largeCPs = cps_range(0x20, 0xFFFF);
+
+    rn.run(std::format("subsetter.smallCPs.{}", tag), unit::codepoints, [&]() { return subset(smallCPs, 1); });
+    rn.run(std::format("subsetter.largeCPs.{}", tag), unit::codepoints, [&]() { return subset(largeCPs, 1); });
+    rn.run(std::format("subsetter.manyFaces32.{}", tag), unit::codepoints, [&]() { return subset(largeCPs, 32); });
+
+    // Text input, mostly ASCII and mostly CJK
+    std::string const latinText = utf8_text(smallCPs, 1024 * 1024);
+    std::string const cjkText   = utf8_text(cps_range(0x4E00, 0x9FFF), 1024 * 1024);
+    auto const        subsetText = [&](std::string const &text) -> std::optional<uint64_t> {
+        otfccxx::Subsetter subs;
+        subs.add_ff_toSubset(src).add_toKeep_text(text);
+        if (auto exp_res = subs.execute_bestEffort(); not exp_res.has_value()) { return std::nullopt; }
+        return text.size();
+    };
+    rn.run(std::format("subsetter.textLatin1MiB.{}", tag), unit::bytes, [&]() { return subsetText(latinText); });
+    rn.run(std::format("subsetter.textCJK1MiB.{}", tag), unit::bytes, [&]() { return subsetText(cjkText); });
+
+    // Incremental, the client holds the first half of the large range and asks for the second half
+    rn.run(std::format("subsetter.delta.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+        otfccxx::CPRange const held{0x20, 0x7FFF};
+        otfccxx::Subsetter     subs;
+        subs.add_ff_toSubset(src).add_toKeep_CPRange(0x8000, 0xFFFF);
+        auto exp_res = subs.execute_delta(std::span(&held, 1));
+        if (not exp_res.has_value()) { return std::nullopt; }
+        uint64_t fontBytes = 0;
+        for (auto const &dlt : exp_res.value()) { fontBytes += dlt.font.size(); }
+        return fontBytes;
+    });
+
+    // Modifier
+    rn.run(std::format("modifier.parse.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+        otfccxx::Modifier modi(src);
+        return font.size();
+    });
+    // Against modifier.parse, the snapshot still goes through otfcc's SFNT reader and clone() copies the built font
+    {
+        otfccxx::Modifier base(src);
+        auto              exp_snap = base.save_snapshot();
+        if (exp_snap.has_value()) {
+            otfccxx::Bytes const snap = std::move(exp_snap.value());
+            rn.run(std::format("modifier.fromSnapshot.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+                auto exp_modi = otfccxx::Modifier::from_snapshot(snap);
+                if (not exp_modi.has_value()) { return std::nullopt; }
+                return font.size();
+            });
+        }
+        rn.run(std::format("modifier.clone.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+            auto exp_modi = base.clone();
+            if (not exp_modi.has_value()) { return std::nullopt; }
+            return font.size();
+        });
+    }
+    rn.run(std::format("modifier.unitsPerEm.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+        otfccxx::Modifier modi(src);
+        if (not modi.change_unitsPerEm(2048).has_value()) { return std::nullopt; }
+        return font.size();
+    });
+    rn.run(std::format("modifier.monospace.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+        otfccxx::Modifier modi(src);
+        if (not modi.change_makeMonospaced_byEmRatio(0.6).has_value()) { return std::nullopt; }
+        return font.size();
+    });
+    rn.run(std::format("modifier.export.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+        otfccxx::Modifier modi(src);
+        auto              exp_res = modi.exportResult();
+        if (not exp_res.has_value()) { return std::nullopt; }
+        return font.size();
+    });
+    // Scaling of the table parsing and building over threads
+    for (size_t const threads : {1uz, 2uz, 4uz, 8uz}) {
+        rn.run(
+            std::format("modifier.parseThreads{}.{}", threads, tag), unit::bytes,
+            [&]() -> std::optional<uint64_t> {
+                otfccxx::Modifier modi(src, 0, otfccxx::Options(1, true).set_threadCount(threads));
+                return font.size();
+            },
+            threads > 1);
+        rn.run(
+            std::format("modifier.exportThreads{}.{}", threads, tag), unit::bytes,
+            [&]() -> std::optional<uint64_t> {
+                otfccxx::Modifier modi(src);
+                auto              exp_res = modi.exportResult(otfccxx::Options(1).set_threadCount(threads));
+                if (not exp_res.has_value()) { return std::nullopt; }
+                return font.size();
+            },
+            threads > 1);
+    }
+    rn.run(std::format("modifier.fullPipeline.{}", tag), unit::bytes, [&]() -> std::optional<uint64_t> {
+        otfccxx::Modifier modi(src);
+        if (not modi.remove_ttfHints().has_value()) { return std::nullopt; }
+        if (not modi.change_unitsPerEm(2048).has_value()) { return std::nullopt; }
+        if (not modi.change_makeMonospaced_byEmRatio(0.6).has_value()) { return std::nullopt; }
+        auto exp_res = modi.exportResult();
+        if (not exp_res.has_value()) { return std::nullopt; }
+        return font.size();
+    });
+}
+
+std::optional<Config>
+parse_args(int argc, char *argv[]) {
+    Config cfg;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view const arg     = argv[i];
+        auto const             nextArg = [&]() -> std::optional<std::string> {
+            if (i + 1 >= argc) { return std::nullopt; }
+            return std::string(argv[++i]);
+        };
+
+        if (arg == "--font"sv) {
+            if (auto v = nextArg()) { cfg.fontPaths.push_back(*v); }
+            else { return std::nullopt; }
+        }
+        else if (arg == "--iterations"sv) {
+            if (auto v = nextArg()) { cfg.iterations = std::max(1ul, std::strtoul(v->c_str(), nullptr, 10)); }
+            else { return std::nullopt; }
+        }
+        else if (arg == "--filter"sv) {
+            if (auto v = nextArg()) { cfg.filter = *v; }
+            else { return std::nullopt; }
+        }
+        else if (arg == "--out"sv) {
+            if (auto v = nextArg()) { cfg.outPath = *v; }
+            else { return std::nullopt; }
+        }
+        else if (arg == "--trace"sv) {
+            if (auto v = nextArg()) { cfg.tracePath = *v; }
+            else { return std::nullopt; }
+        }
+        else if (arg == "--metrics"sv) {
+            if (auto v = nextArg()) { cfg.metricsPath = *v; }
+            else { return std::nullopt; }
+        }
+        else if (arg == "--alloc-budget"sv) {
+            if (auto v = nextArg()) { cfg.allocBudgetPath = *v; }
+            else { return std::nullopt; }
+        }
+        else if (arg == "--alloc-record"sv) {
+            if (auto v = nextArg()) { cfg.allocRecordPath = *v; }
+            else { return std::nullopt; }
+        }
+        else { return std::nullopt; }
+    }
+    if (cfg.fontPaths.empty()) {
+        if (const char *envFont = std::getenv("OTFCCXX_BENCH_FONT"); envFont != nullptr && *envFont != '\0') {
+            cfg.fontPaths.emplace_back(envFont);
+        }
+    }
+    return cfg;
+}
+
+} // namespace
+
+
+int
+main(int argc, char *argv[]) {
+    auto cfg = parse_args(argc, argv);
+    if (not cfg.has_value()) {
+        std::cerr << "Usage: otfccxx_bench [--font <path>]... [--iterations <n>] [--filter <substring>] "
+                     "[--out <file.json>] [--trace <file.json>] [--metrics <file.prom>] "
+                     "[--alloc-budget <file>] [--alloc-record <file>]\n";
+        return 2;
+    }
+
+    otfccxx::ChromeTraceSink traceSink;
+    if (not cfg->tracePath.empty()) { otfccxx::set_traceSink(&traceSink); }
+
+    Runner rn(*cfg);
+    bench_base64(rn);
+
+    std::pair<std::string_view, otfccxx::SyntheticFontSpec> const synthSpecs[] = {
+        {"synthLatin"sv, otfccxx::FontSynthesizer::preset_latin()},
+        {"synthCJK"sv, otfccxx::FontSynthesizer::preset_cjk()},
+        {"synthDeepComposites"sv, otfccxx::FontSynthesizer::preset_deepComposites()},
+    };
+    for (auto const &[tag, spec] : synthSpecs) {
+        auto exp_bytes = otfccxx::FontSynthesizer::generate(spec);
+        if (not exp_bytes.has_value()) {
+            rn.skip(std::string(tag), "cannot generate synthetic font");
+            continue;
+        }
+        auto exp_src = otfccxx::FontSource::from_bytes(std::move(exp_bytes.value()));
+        if (not exp_src.has_value()) {
+            rn.skip(std::string(tag), "synthetic font is not a valid SFNT");
+            continue;
+        }
+        bench_font(rn, std::string(tag), exp_src.value());
+    }
+
+    for (size_t i = 0; i < cfg->fontPaths.size(); ++i) {
+        auto exp_src = otfccxx::FontSource::from_file(cfg->fontPaths[i]);
+        if (not exp_src.has_value()) {
+            rn.skip(std::format("font{}", i), "cannot load " + cfg->fontPaths[i]);
+            continue;
+        }
+        bench_font(rn, std::format("font{}", i), exp_src.value());
+    }
+
+    otfccxx::set_traceSink(nullptr);
+    if (not cfg->tracePath.empty() && not traceSink.write_toFile(cfg->tracePath).has_value()) {
+        std::cerr << "[otfccxx_bench] cannot write " << cfg->tracePath << '\n';
+    }
+
+    if (not cfg->metricsPath.empty() && not otfccxx::metrics_writePrometheus(cfg->metricsPath).has_value()) {
+        std::cerr << "[otfccxx_bench] cannot write " << cfg->metricsPath << '\n';
+    }
+
+    std::string const json = rn.to_json();
+    if (cfg->outPath.empty()) { std::cout << json; }
+    else if (auto exp_w = otfccxx::write_bytesToFile_atomic(cfg->outPath, std::as_bytes(std::span(json)));
+             not exp_w.has_value()) {
+        std::cerr << "[otfccxx_bench] cannot write " << cfg->outPath << '\n';
+        return 1;
+    }
+
+    // Allocation budget
+    if ((not cfg->allocRecordPath.empty() || not cfg->allocBudgetPath.empty()) &&
+        not otfccxx::alloc_accountingEnabled()) {
+        std::cerr << "[otfccxx_bench] allocation accounting is off (build with otfccxx_ALLOC_ACCOUNTING)\n";
+        return 4;
+    }
+    if (not cfg->allocRecordPath.empty()) {
+        std::string const budget = rn.to_allocBudget();
+        if (not otfccxx::write_bytesToFile_atomic(cfg->allocRecordPath, std::as_bytes(std::span(budget)))
+                    .has_value()) {
+            std::cerr << "[otfccxx_bench] cannot write " << cfg->allocRecordPath << '\n';
+            return 1;
+        }
+    }
+    if (not cfg->allocBudgetPath.empty()) {
+        std::ifstream ifs(cfg->allocBudgetPath);
+        if (not ifs.is_open()) {
+            std::cerr << "[otfccxx_bench] cannot read " << cfg->allocBudgetPath << '\n';
+            return 1;
+        }
+        std::string const budget((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+        if (auto const violations = rn.check_allocBudget(budget); not violations.empty()) {
+            for (auto const &v : violations) { std::cerr << "[otfccxx_bench] over allocation budget: " << v << '\n'; }
+            return 3;
+        }
+    }
+    return 0;
+}
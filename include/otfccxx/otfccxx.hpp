@@ -1,9 +1,17 @@
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <expected>
 #include <filesystem>
+#include <functional>
+#include <future>
 #include <memory>
+#include <optional>
 #include <span>
+#include <stop_token>
+#include <string>
 #include <string_view>
 #include <utility>
 
@@ -36,6 +44,8 @@ namespace otfccxx {
 class Modifier;
 class Subsetter;
 class Options;
+class FontSource;
+class FontSynthesizer;
 
 
 // #####################################################################
@@ -68,6 +78,13 @@ enum class err_subset : size_t {
     make_subset_noIntersectingGlyphs,
     jsonAdvanceWidthKeyNotFound,
     jsonFontMissingGlyfTable,
+    text_invalidUTF8,
+    text_invalidUTF16,
+    text_fileReadFailure,
+    cancelled,
+    deadlineExceeded,
+    lazyFace_loadFailure,
+    merge_failure,
 };
 enum class err_modifier : size_t {
     unknownError = 1,
@@ -83,22 +100,338 @@ enum class err_modifier : size_t {
     ratioAdvWidthToEmSize_cannotBeOver2,
     newEmSize_outsideValidValueRange,
     otfccHandle_notIndex,
+    cancelled,
+    deadlineExceeded,
+    fontMustBeDiscarded,
+    snapshot_invalid,
+    snapshot_stale,
+    clone_failed,
+    json_invalid,
+    merge_cffOutlines,
+    cannotOpenFile,
+    sfnt_invalid,
+    ttcIndexOutOfRange,
+    font_unreadable,
 };
 enum class err_converter : size_t {
     unknownError = 1,
     unexpectedNullptr,
     woff2_dataInvalid,
-    woff2_decompressionFailed
+    woff2_decompressionFailed,
+    base64_dataInvalid,
+    outputBufferTooSmall,
+    patch_dataInvalid,
+    patch_baseMismatch,
+    cancelled,
+    deadlineExceeded,
+};
+enum class err_fontSource : size_t {
+    unknownError = 1,
+    cannotOpenFile,
+    cannotMapFile,
+    emptyData,
+    notAnSFNT,
+    tableDirectoryCorrupted,
+};
+enum class err_coverageIndex : size_t {
+    unknownError = 1,
+    cannotOpenFile,
+    notAnIndex,
+    unsupportedVersion,
+    dataCorrupted,
+};
+enum class err_write : size_t {
+    unknownError = 1,
+    pathHasNoFilename,
+    cannotCreateParentDirectory,
+    cannotCreateTempFile,
+    writeFailed,
+    fsyncFailed,
+    renameFailed,
+};
+enum class err_synth : size_t {
+    unknownError = 1,
+    unexpectedNullptr,
+    glyphCountOutOfRange,
+    pointsPerContourTooLow,
+    cmapRangeInvalid,
+    serializationFailure,
+};
+
+
+// #####################################################################
+// ### Writing output files ###
+// #####################################################################
+
+struct WriteOptions {
+    // Flush file content (and on POSIX also the directory entry) to stable storage before returning
+    bool fsync = false;
+    // Create missing parent directories (only attempted when the first open fails because of them)
+    bool createParentDirs = true;
+};
+
+struct WriteJob {
+    std::filesystem::path path;
+    ByteSpan              bytes;
 };
 
 OTFCCXX_API std::expected<bool, std::filesystem::file_type>
             write_bytesToFile(std::filesystem::path const &p, ByteSpan bytes);
 
+// Writes 'bytes' to a uniquely named temporary file next to 'p' (created exclusively, O_EXCL / CREATE_NEW) and
+// renames it into place.
+// Readers of 'p' never observe a partially written file. Returns the number of bytes written.
+OTFCCXX_API std::expected<size_t, err_write>
+            write_bytesToFile_atomic(std::filesystem::path const &p, ByteSpan bytes, WriteOptions const &opts = {});
+
+// Batch variant of the above, the jobs are distributed over 'threadCount' threads (0 means hardware concurrency).
+// Results are in the same order as 'jobs'.
+OTFCCXX_API std::vector<std::expected<size_t, err_write>>
+            write_bytesToFiles_atomic(std::span<const WriteJob> jobs, WriteOptions const &opts = {},
+                                      size_t threadCount = 0);
+
+
+// #####################################################################
+// ### Tracing ###
+// #####################################################################
+
+// One finished stage of a library call (eg. "subsetter.hbSubset" or "modifier.serialize"). 'stage' always refers to a
+// string literal. Byte and glyph counts are 0 where they don't apply to the stage.
+struct TraceEvent {
+    std::string_view                      stage;
+    std::chrono::steady_clock::time_point start;
+    std::chrono::nanoseconds              duration{0};
+    uint64_t                              bytesIn    = 0;
+    uint64_t                              bytesOut   = 0;
+    uint64_t                              glyphCount = 0;
+    uint64_t                              threadID   = 0;
+};
+
+// Receives the events of all threads, so 'on_event' must be thread safe
+class OTFCCXX_API TraceSink {
+public:
+    virtual ~TraceSink() = default;
+
+    virtual void
+    on_event(TraceEvent const &ev) noexcept = 0;
+};
+
+// Installs a process wide sink, nullptr uninstalls it. The sink is not owned and has to outlive every library call
+// that started while it was installed. Without a sink every stage costs one atomic load and a branch.
+OTFCCXX_API void
+set_traceSink(TraceSink *sink) noexcept;
+OTFCCXX_API TraceSink *
+get_traceSink() noexcept;
+
+// Collects the events in memory and renders them as Chrome trace-event JSON (chrome://tracing, Perfetto UI)
+class OTFCCXX_API ChromeTraceSink final : public TraceSink {
+public:
+    ChromeTraceSink();
+    ~ChromeTraceSink() override;
+
+    void
+    on_event(TraceEvent const &ev) noexcept override;
+
+    std::string
+    to_json() const;
+    std::expected<size_t, err_write>
+    write_toFile(std::filesystem::path const &p) const;
+
+    void
+    clear() noexcept;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl;
+};
+
+
+// #####################################################################
+// ### Metrics ###
+// #####################################################################
+
+// The library keeps counters and log2 histograms of its own activity (per thread, lock-free) and merges them on read
+struct MetricsCounter {
+    std::string_view name; // Prometheus metric name, eg. "otfccxx_subsets_executed_total"
+    std::string_view help;
+    uint64_t         value = 0;
+};
+
+struct OTFCCXX_API MetricsHistogram {
+    // Bucket 0 counts zeros, bucket i counts values in [2^(i-1), 2^i - 1]
+    static constexpr size_t bucketCount = 65;
+
+    std::string_view                  name;
+    std::string_view                  help;
+    std::array<uint64_t, bucketCount> buckets{};
+    uint64_t                          count = 0;
+    uint64_t                          sum   = 0;
+
+    // Upper bound of the bucket holding the q-quantile (0.0 - 1.0), ie. accurate within a factor of 2
+    uint64_t
+    quantile(double q) const noexcept;
+};
+
+struct OTFCCXX_API MetricsSnapshot {
+    std::vector<MetricsCounter>   counters;
+    std::vector<MetricsHistogram> histograms;
+
+    std::optional<uint64_t>
+    counter(std::string_view name) const noexcept;
+    const MetricsHistogram *
+    histogram(std::string_view name) const noexcept;
+
+    // Prometheus text exposition format (version 0.0.4)
+    std::string
+    to_prometheus() const;
+};
+
+OTFCCXX_API MetricsSnapshot
+metrics_snapshot();
+OTFCCXX_API void
+metrics_reset() noexcept;
+OTFCCXX_API std::expected<size_t, err_write>
+metrics_writePrometheus(std::filesystem::path const &p);
+
+
+// #####################################################################
+// ### Allocation accounting ###
+// #####################################################################
+
+// Only counts when the library was built with otfccxx_ALLOC_ACCOUNTING, which replaces the global operator new/delete
+// (on Windows only inside the DLL). Allocations made by the C dependencies through malloc are not included.
+struct AllocStats {
+    uint64_t allocations = 0;
+    uint64_t bytes       = 0;
+};
+struct AllocCallStats {
+    std::string_view call; // eg. "Modifier::exportResult"
+    uint64_t         calls = 0;
+    AllocStats       total;
+};
+
+OTFCCXX_API bool
+alloc_accountingEnabled() noexcept;
+// Allocations made by the calling thread since it started
+OTFCCXX_API AllocStats
+alloc_threadTotals() noexcept;
+// Allocations per public API call summed over all threads. Nested API calls count towards the outermost one only.
+OTFCCXX_API std::vector<AllocCallStats>
+alloc_perCall();
+OTFCCXX_API void
+alloc_reset() noexcept;
+
+
+// #####################################################################
+// ### Async execution ###
+// #####################################################################
+
+// Cancellation and deadline of one async call. Checked between faces (Subsetter) and between processing stages
+// (Modifier, Converter). A stopped call finishes with the 'cancelled' or 'deadlineExceeded' error of its component.
+struct ExecControl {
+    std::stop_token                       stopToken;
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+    static ExecControl
+    within(std::chrono::steady_clock::duration const timeout, std::stop_token stopToken = {}) {
+        return ExecControl{std::move(stopToken), std::chrono::steady_clock::now() + timeout};
+    }
+};
+
+// Runs the tasks of async calls. Implementations must run every submitted task exactly once.
+class OTFCCXX_API Executor {
+public:
+    virtual ~Executor() = default;
+
+    virtual void
+    submit(std::move_only_function<void()> task) = 0;
+};
+
+// Fixed number of worker threads (0 = std::thread::hardware_concurrency()). The destructor runs all tasks submitted
+// so far and then joins the workers. Waiting for async results from inside its own tasks may deadlock.
+class OTFCCXX_API ThreadPoolExecutor final : public Executor {
+public:
+    explicit ThreadPoolExecutor(size_t threadCount = 0);
+    ~ThreadPoolExecutor() override;
+
+    ThreadPoolExecutor(const ThreadPoolExecutor &) = delete;
+    ThreadPoolExecutor &
+    operator=(const ThreadPoolExecutor &) = delete;
+
+    void
+    submit(std::move_only_function<void()> task) override;
+    size_t
+    thread_count() const noexcept;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pimpl;
+};
+
+// Process wide pool (created on first use, never destroyed), used by async calls that don't get an executor
+OTFCCXX_API Executor &
+default_executor();
+
 
 // #####################################################################
 // ### Classes forming the public interface ###
 // #####################################################################
 
+// One entry of an SFNT table directory
+struct TableRecord {
+    uint32_t tag;
+    uint32_t checksum;
+    uint32_t offset;
+    uint32_t length;
+};
+
+// Font file data loaded once (memory mapped file or a byte buffer) and shared by reference counting.
+// Copies are cheap and refer to the same data. Can be fed to Subsetter, Modifier and Converter (Subsetter then doesn't
+// copy the data at all). The table directory of each face is parsed on load, the content fingerprint on first use.
+class OTFCCXX_API FontSource {
+public:
+    [[nodiscard]] static std::expected<FontSource, err_fontSource>
+    from_file(std::filesystem::path const &pth);
+    // Copies 'bytes'
+    [[nodiscard]] static std::expected<FontSource, err_fontSource>
+    from_bytes(ByteSpan bytes);
+    [[nodiscard]] static std::expected<FontSource, err_fontSource>
+    from_bytes(Bytes &&bytes);
+    // Does NOT copy, 'bytes' must outlive all copies of the FontSource and everything created from them
+    [[nodiscard]] static std::expected<FontSource, err_fontSource>
+    from_unownedBytes(ByteSpan bytes);
+
+    FontSource(const FontSource &) = default;
+    FontSource(FontSource &&) noexcept = default;
+    FontSource &
+    operator=(const FontSource &) = default;
+    FontSource &
+    operator=(FontSource &&) noexcept = default;
+    ~FontSource();
+
+    ByteSpan
+    bytes() const noexcept;
+    // Number of faces (> 1 only for font collections)
+    uint32_t
+    face_count() const noexcept;
+    // Empty span if 'faceIndex' is out of range
+    std::span<const TableRecord>
+    table_directory(uint32_t faceIndex = 0) const noexcept;
+    std::optional<TableRecord>
+    find_table(uint32_t tag, uint32_t faceIndex = 0) const noexcept;
+    // XXH64 of the whole data, computed once per loaded data
+    uint64_t
+    fingerprint() const;
+
+private:
+    friend class Subsetter;
+    friend class Modifier;
+
+    class Impl;
+    explicit FontSource(std::shared_ptr<const Impl> impl) noexcept;
+    std::shared_ptr<const Impl> pimpl;
+};
+
 // Simply wraps otfcc_Options
 class OTFCCXX_API Options {
 private:
@@ -109,16 +442,159 @@ public:
     Options(const Options &) = delete;
     Options &
     operator=(const Options &) = delete;
+    Options(Options &&) noexcept;
+    Options &
+    operator=(Options &&) noexcept;
 
     ~Options();
 
+    // Threads that parse the font's tables when a Modifier is created and build them in Modifier::exportResult()
+    // (0 = hardware concurrency). The default of 1 keeps all the work on the calling thread.
+    Options &
+    set_threadCount(size_t threadCount) noexcept;
+
 private:
     friend class Modifier;
+    friend class FontSynthesizer;
 
     class Impl;
     std::unique_ptr<Impl> pimpl;
 };
 
+// Inclusive range of unicode codepoints
+struct CPRange {
+    uint32_t first = 0;
+    uint32_t last  = 0;
+};
+
+// Part of the Subsetter waterfall a font goes into
+enum class WaterfallGroup : uint8_t {
+    toSubset,
+    categoryBackup,
+    lastResort,
+};
+struct CoverageFont {
+    std::filesystem::path path;
+    uint32_t              faceIndex = 0;
+    WaterfallGroup        group     = WaterfallGroup::lastResort;
+};
+
+// Codepoint coverage of a list of font files, stored in a compact versioned file that is memory mapped on open.
+// A Subsetter registers all the fonts of an index lazily without opening any of them (see add_coverageIndex()).
+// Each entry also records the XXH64 content hash of its file (and its size and modification time as a cheap change
+// check). Copies are cheap and refer to the same data.
+class OTFCCXX_API CoverageIndex {
+public:
+    // Scans the cmap of each font, unreadable fonts are left out. Entries of 'previous' are reused for files whose size
+    // and modification time didn't change, or whose content hash didn't, ie. only changed fonts are rescanned.
+    [[nodiscard]] static std::expected<CoverageIndex, err_coverageIndex>
+    build(std::span<const CoverageFont> fonts, CoverageIndex const *previous = nullptr);
+    // The whole file is validated (and hashed) once, coverage is then read from the mapping directly
+    [[nodiscard]] static std::expected<CoverageIndex, err_coverageIndex>
+    open(std::filesystem::path const &pth);
+
+    CoverageIndex(const CoverageIndex &) = default;
+    CoverageIndex(CoverageIndex &&) noexcept = default;
+    CoverageIndex &
+    operator=(const CoverageIndex &) = default;
+    CoverageIndex &
+    operator=(CoverageIndex &&) noexcept = default;
+    ~CoverageIndex();
+
+    // build() over the same fonts with this index as 'previous'
+    [[nodiscard]] std::expected<CoverageIndex, err_coverageIndex>
+    refreshed() const;
+
+    std::expected<size_t, err_write>
+    write_toFile(std::filesystem::path const &pth) const;
+    // The serialized index, exactly what write_toFile() writes
+    ByteSpan
+    bytes() const noexcept;
+
+    size_t
+    font_count() const noexcept;
+    CoverageFont
+    font(size_t i) const;
+    uint64_t
+    content_hash(size_t i) const noexcept;
+    // Sorted inclusive ranges
+    std::vector<CPRange>
+    coverage(size_t i) const;
+
+private:
+    friend class Subsetter;
+
+    class Impl;
+    explicit CoverageIndex(std::shared_ptr<const Impl> impl) noexcept;
+    std::shared_ptr<const Impl> pimpl;
+};
+
+// Progress of a long running Modifier operation, 'done' out of 'total' glyphs (or export stages)
+struct ModifierProgress {
+    std::string_view operation; // eg. "change_unitsPerEm"
+    std::string_view stage;     // "glyphs", or for exportResult "consolidate", "serialize"
+    size_t           done  = 0;
+    size_t           total = 0;
+};
+// Runs on the thread of the operation, must not throw
+using ProgressCallback = std::function<void(ModifierProgress const &)>;
+
+// Tables (and 'name' records) that go into an exported font, see Subsetter::set_tableProfile() and
+// Modifier::apply_tableProfile(). Tags are the 4 character codes big endian, eg. 0x4C545348 for 'LTSH', otfcc's
+// spellings ('OS_2', 'cvt_', 'CFF_', 'SVG_') are understood as well. The tables a font can't do without (head, hhea,
+// maxp, OS/2, hmtx, post, cmap, name, glyf, loca, CFF, CFF2) are always kept.
+struct OTFCCXX_API TableProfile {
+    enum class Mode : uint8_t {
+        keepListed, // Only 'tables' (and the required ones) are kept
+        dropListed, // 'tables' are dropped
+    };
+    Mode                  mode = Mode::dropListed;
+    std::vector<uint32_t> tables;
+    // 'name' records to keep by nameID, empty means all
+    std::vector<uint16_t> nameIDs;
+
+    bool
+    keeps(uint32_t tag) const noexcept;
+
+    // Outlines, metrics, cmap, layout and color tables (COLR/CPAL, CBDT/CBLC, sbix, SVG), family/style/unique/full/
+    // version/PostScript names
+    static TableProfile
+    web_minimal();
+    // web_minimal() without GPOS and color, for monospaced grids (GSUB stays for programming ligatures)
+    static TableProfile
+    terminal();
+    // Drops what no renderer reads: LTSH, hdmx, VDMX, meta, DSIG and the TSI* sources of VTT
+    static TableProfile
+    drop_unused();
+};
+
+// One variant for Modifier::export_variants(). The steps that are set run on a copy of the base font in this order:
+// unitsPerEm, monospacing (the advance width wins over the em ratio, which refers to the new unitsPerEm), hint removal,
+// table profile.
+struct ModifierRecipe {
+    std::optional<uint32_t>     unitsPerEm;
+    std::optional<uint32_t>     monospacedAdvWidth;
+    std::optional<double>       monospacedEmRatio;
+    bool                        removeTTFHints = false;
+    std::optional<TableProfile> tableProfile;
+
+    Options exportOpts = Options(1);
+};
+
+// One face of an incremental subset, see Subsetter::execute_delta()
+struct SubsetDelta {
+    size_t faceSlot  = 0;     // Position of the face in the waterfall (toSubset, categoryBackup, lastResort in order)
+    bool   isNewFace = false; // Nothing of this face was held before, 'patch' then applies to an empty 'previous'
+    Bytes  font;              // Extended subset with the glyph IDs of the original font
+    Bytes  patch;             // 'previous' -> 'font', see Converter::apply_subsetPatch()
+    size_t previousBytes = 0; // Size of the output the client already holds
+
+    size_t
+    bytesSaved() const noexcept {
+        return font.size() > patch.size() ? font.size() - patch.size() : 0;
+    }
+};
+
 // 'Waterfall' subsetter that subsets a collection of fonts in a priority waterfall fashion based on the requested
 // unicode codepoints. Has 'builder pattern' - like interface.
 class OTFCCXX_API Subsetter {
@@ -148,6 +624,32 @@ public:
     Subsetter &
     add_ff_lastResort(std::filesystem::path const &pth, unsigned int const faceIndex = 0u);
 
+    // The face keeps a reference to the FontSource data, nothing is copied
+    Subsetter &
+    add_ff_toSubset(FontSource const &src, unsigned int const faceIndex = 0u);
+    Subsetter &
+    add_ff_categoryBackup(FontSource const &src, unsigned int const faceIndex = 0u);
+    Subsetter &
+    add_ff_lastResort(FontSource const &src, unsigned int const faceIndex = 0u);
+
+    // Only the codepoint coverage stays resident, the face is memory mapped on first use and unmapped again (least
+    // recently used first) when the loaded lazy faces exceed the budget. Same waterfall semantics as above, faces that
+    // cover none of the remaining codepoints aren't loaded at all. A file that became unreadable fails the execution
+    // with 'lazyFace_loadFailure'.
+    Subsetter &
+    add_ff_toSubset_lazy(std::filesystem::path const &pth, unsigned int const faceIndex = 0u);
+    Subsetter &
+    add_ff_categoryBackup_lazy(std::filesystem::path const &pth, unsigned int const faceIndex = 0u);
+    Subsetter &
+    add_ff_lastResort_lazy(std::filesystem::path const &pth, unsigned int const faceIndex = 0u);
+    // Every font of the index, lazily and into its own group (in index order). Coverage comes straight from the
+    // index, a font is only rescanned if its content hash turns out different when it gets loaded.
+    Subsetter &
+    add_coverageIndex(CoverageIndex const &idx);
+    // In bytes of font data, 0 = unlimited (default). The face in use stays loaded even if it alone is larger.
+    Subsetter &
+    set_faceMemoryBudget(size_t bytes);
+
     // Subsetter &add_ff_toSubset(hb_face_t *ptr, unsigned int const faceIndex =
     // 0u); Subsetter &add_ff_categoryBackup(hb_face_t *ptr, unsigned int const
     // faceIndex = 0u); Subsetter &add_ff_lastResort(hb_face_t *ptr, unsigned int
@@ -157,6 +659,41 @@ public:
     add_toKeep_CP(uint32_t cp);
     Subsetter &
     add_toKeep_CPs(std::span<const uint32_t> cps);
+    // 'sortedCPs' must be sorted ascending, inserted in bulk
+    Subsetter &
+    add_toKeep_CPsSorted(std::span<const uint32_t> sortedCPs);
+    // Inclusive ranges, ie. [first, last]. Empty ranges (first > last) are ignored.
+    Subsetter &
+    add_toKeep_CPRange(uint32_t first, uint32_t last);
+    Subsetter &
+    add_toKeep_CPRanges(std::span<const CPRange> ranges);
+    // Bit i of bitmap[w] stands for codepoint 'firstCP + w * 64 + i'
+    Subsetter &
+    add_toKeep_CPBitmap(std::span<const uint64_t> bitmap, uint32_t firstCP = 0);
+
+    // Keeps every codepoint that occurs in the text (UTF-16 in native byte order, a leading BOM is ignored).
+    // Invalid text is dropped as a whole and puts the Subsetter in error (see get_error()). Also ends any text that is
+    // being streamed in chunks.
+    Subsetter &
+    add_toKeep_text(std::string_view utf8);
+    Subsetter &
+    add_toKeep_text(std::u8string_view utf8);
+    Subsetter &
+    add_toKeep_text(std::u16string_view utf16);
+    // Same for text that comes in chunks, which may be split anywhere (even inside a multi-byte sequence).
+    // finish_text() ends the text (execution does so implicitly). UTF-8 and UTF-16 text may be streamed at the same
+    // time.
+    Subsetter &
+    add_toKeep_textChunk(std::string_view utf8Chunk);
+    Subsetter &
+    add_toKeep_textChunk(std::u8string_view utf8Chunk);
+    Subsetter &
+    add_toKeep_textChunk(std::u16string_view utf16Chunk);
+    Subsetter &
+    finish_text();
+    // UTF-8 text file, read in chunks
+    Subsetter &
+    add_toKeep_textFile(std::filesystem::path const &pth);
 
     // 1) execute() - Get 'waterfall of font faces'
     // 2) execute_bestEffort() - Get 'waterfall of font faces' + set(in a vector)
@@ -165,6 +702,33 @@ public:
     execute();
     std::expected<std::pair<std::vector<Bytes>, std::vector<uint32_t>>, err_subset>
     execute_bestEffort();
+    // Same as execute_bestEffort() but the missing codepoints come as inclusive ranges
+    std::expected<std::pair<std::vector<Bytes>, std::vector<CPRange>>, err_subset>
+    execute_bestEffortRanges();
+    // execute() merged into one font, ie. one file, one parse and one glyph cache on the client instead of a CSS
+    // fallback chain. Each subset adds its glyphs to the first one (see Modifier::merge_glyphsFrom(), which also
+    // unifies the unitsPerEm), then 'recipe' runs on the result (eg. to monospace it) and it is exported with
+    // 'recipe.exportOpts'. A failure while merging is 'merge_failure'.
+    std::expected<Bytes, err_subset>
+    execute_merged(ModifierRecipe const &recipe = {});
+
+    // Subsets keep the glyph IDs of the original fonts (unused glyphs become empty). Off by default.
+    Subsetter &
+    set_retainGlyphIDs(bool retain);
+    // Tables and 'name' records of the subsets, on top of what harfbuzz drops by default. Dropping any of 'fpgm',
+    // 'prep' or 'cvt ' strips all hinting (the glyph instructions included).
+    Subsetter &
+    set_tableProfile(TableProfile profile);
+    // Incremental mode for clients that already hold the (glyph ID retaining) subsets for 'clientHas'.
+    // Produces subsets for 'clientHas' + the codepoints to keep, each with a patch against what the client holds.
+    // Subsets twice internally (the client's version is rebuilt, subsetting is deterministic). Best effort, ie.
+    // codepoints that weren't found anywhere are simply left out.
+    std::expected<std::vector<SubsetDelta>, err_subset>
+    execute_delta(std::span<const CPRange> clientHas);
+
+    // execute() on 'exec', the Subsetter moves into the task
+    [[nodiscard]] static std::future<std::expected<std::vector<Bytes>, err_subset>>
+    execute_async(Subsetter subs, ExecControl ctl = {}, Executor &exec = default_executor());
 
     bool
     is_inError();
@@ -181,12 +745,58 @@ private:
 // TTF hints are always removed from the font
 class OTFCCXX_API Modifier {
 public:
+    // A font that can't be read leaves the Modifier without one, every operation then fails with 'unexpectedNullptr'.
+    // create_async() reports why instead.
     Modifier(ByteSpan raw_ttfFont, uint32_t ttcindex = 0, Options const &opts = otfccxx::Options(1, true));
     Modifier(std::filesystem::path const &pth, uint32_t ttcindex = 0, Options const &opts = otfccxx::Options(1, true));
+    Modifier(FontSource const &src, uint32_t ttcindex = 0, Options const &opts = otfccxx::Options(1, true));
 
     Modifier() = delete;
     ~Modifier();
 
+    Modifier(Modifier &&) noexcept;
+    Modifier &
+    operator=(Modifier &&) noexcept;
+
+    // Independent copy of the font in its current state (incl. the ExecControl and progress settings), a deep copy of
+    // the built tables that doesn't read the font again. Meant for fanning out several variants of one font, the
+    // 'modifier.clone' bench case measures it next to 'modifier.parse'.
+    [[nodiscard]] std::expected<Modifier, err_modifier>
+    clone() const;
+
+    // Every recipe is applied to its own clone() of 'base' and exported, all in parallel on 'exec'. The workers copy
+    // from the one parsed base font, which is only read. Results are in the order of 'recipes', the variants don't
+    // report progress and a failed variant doesn't affect the others.
+    [[nodiscard]] static std::vector<std::future<std::expected<Bytes, err_modifier>>>
+    exportVariants_async(Modifier base, std::vector<ModifierRecipe> recipes, ExecControl ctl = {},
+                         Executor &exec = default_executor());
+    // Same as above with this Modifier as the base, blocks until all variants are done
+    [[nodiscard]] std::vector<std::expected<Bytes, err_modifier>>
+    export_variants(std::vector<ModifierRecipe> recipes, ExecControl ctl = {},
+                    Executor &exec = default_executor()) const;
+
+    // Parses 'raw_ttfFont' like the constructor does, but reports a font that can't be read (see create_async())
+    [[nodiscard]] static std::expected<Modifier, err_modifier>
+    create(ByteSpan raw_ttfFont, uint32_t ttcindex = 0, Options const &opts = otfccxx::Options(1, true));
+    // Parses 'src' on 'exec'. Fails with 'sfnt_invalid', 'ttcIndexOutOfRange' or 'font_unreadable' when the font
+    // can't be read.
+    [[nodiscard]] static std::future<std::expected<Modifier, err_modifier>>
+    create_async(FontSource src, uint32_t ttcindex = 0, Options opts = otfccxx::Options(1, true),
+                 ExecControl ctl = {}, Executor &exec = default_executor());
+
+
+    // Cooperative cancellation and progress of the operations below, checked every 'glyphBatch' glyphs and between
+    // export stages. A stopped operation returns 'cancelled' or 'deadlineExceeded' and leaves the font:
+    // - unchanged when stopped before the first glyph or during exportResult()
+    // - valid but only partly unhinted for remove_ttfHints() (calling it again finishes the job)
+    // - half transformed for change_unitsPerEm() / change_makeMonospaced*(), must_discard() then turns true and
+    //   every further operation fails with 'fontMustBeDiscarded'
+    Modifier &
+    set_execControl(ExecControl ctl);
+    Modifier &
+    set_progressCallback(ProgressCallback cb, uint32_t glyphBatch = 1024);
+    bool
+    must_discard() const noexcept;
 
     // Changing dimensions of glyphs
     std::expected<bool, err_modifier>
@@ -199,23 +809,121 @@ public:
     // Filtering of font content (ie. deleting parts of the font)
     void
     delete_fontTable(const uint32_t tag);
+    // Keeps .notdef and the glyphs reachable from 'cps' through 'cmap', composite references and GSUB (every lookup
+    // counts, regardless of feature and context), deletes all other glyphs and the 'cmap' entries outside of 'cps',
+    // then renumbers the glyphs in their original order. Glyph indexed tables otfcc can't renumber (LTSH, hdmx, SVG,
+    // VTT sources) are deleted. Like subsetting with harfbuzz, without the trip through the bytes and parsing again.
+    // Returns the number of glyphs kept. Stopping early leaves the font unchanged.
+    std::expected<size_t, err_modifier>
+    keep_glyphsForCPs(std::span<const uint32_t> cps);
+    std::expected<size_t, err_modifier>
+    keep_glyphsForCPRanges(std::span<const CPRange> ranges);
 
 
     // Modifications of other values and properties
     std::expected<bool, err_modifier>
     remove_ttfHints();
+    // Deletes the tables 'profile' doesn't keep and, when it lists name IDs, the other 'name' records. Dropping any of
+    // 'fpgm', 'prep' or 'cvt ' removes the TTF hints altogether (see remove_ttfHints()).
+    std::expected<bool, err_modifier>
+    apply_tableProfile(TableProfile const &profile);
+    // Runs the steps of 'recipe' that are set, in its order. Its export options aren't used here.
+    std::expected<bool, err_modifier>
+    apply_recipe(ModifierRecipe const &recipe);
+
+    // Merging of fonts
+    // Adds the glyphs 'other' maps the codepoints this font doesn't map to (plus their components), scaled to this
+    // font's unitsPerEm first when that differs. Only glyphs and 'cmap' are taken over, not the layout tables of
+    // 'other', and the added glyphs lose their instructions. TrueType outlines only ('merge_cffOutlines' otherwise).
+    // Returns the number of glyphs added.
+    std::expected<size_t, err_modifier>
+    merge_glyphsFrom(Modifier const &other);
 
 
     // Export
     std::expected<Bytes, err_modifier>
     exportResult(Options const &opts = otfccxx::Options(1));
+    // exportResult() on 'exec', the Modifier moves into the task
+    [[nodiscard]] static std::future<std::expected<Bytes, err_modifier>>
+    exportResult_async(Modifier modi, Options opts = otfccxx::Options(1), ExecControl ctl = {},
+                       Executor &exec = default_executor());
+
+    // otfcc's JSON form of the font (as written by otfccdump and read by otfccbuild). otfcc's dumper builds the whole
+    // document tree in memory first, only the text is then handed to 'sink' in chunks instead of being rendered into
+    // one allocation. 'pretty' indents by 2 spaces. Returns the total size.
+    std::expected<size_t, err_modifier>
+    export_json(std::function<void(std::string_view)> const &sink, bool pretty = false);
+    [[nodiscard]] std::expected<std::string, err_modifier>
+    export_json(bool pretty = false);
+    // Reverse of the above. Like otfccbuild, 'cmap' entries and glyph references naming glyphs missing from 'glyf' are
+    // dropped. When 'opts' removes hints, the hinting tables and glyph instructions are taken out of the document
+    // before otfcc reads it.
+    [[nodiscard]] static std::expected<Modifier, err_modifier>
+    from_json(std::string_view json, Options const &opts = otfccxx::Options(1, true));
+
+    // Snapshot of the parsed font, for creating the same Modifier over and over without the original font. It is the
+    // consolidated font written back as an SFNT plus a checked header, loading it still runs otfcc's SFNT reader and
+    // only skips hint removal and the up-front consolidation ('modifier.fromSnapshot' bench case vs 'modifier.parse').
+    // Records the fingerprint of the font this Modifier was created from (FontSource::fingerprint(), 0 when created
+    // from a path).
+    [[nodiscard]] std::expected<Bytes, err_modifier>
+    save_snapshot();
+    // 'snapshot' is parsed in place, the path variant memory maps the file. 'snapshot_stale' when
+    // 'expectedSourceFingerprint' is given and the snapshot was made from a different font.
+    [[nodiscard]] static std::expected<Modifier, err_modifier>
+    from_snapshot(ByteSpan snapshot, std::optional<uint64_t> expectedSourceFingerprint = std::nullopt);
+    [[nodiscard]] static std::expected<Modifier, err_modifier>
+    from_snapshot(std::filesystem::path const &pth, std::optional<uint64_t> expectedSourceFingerprint = std::nullopt);
 
 private:
     class Impl;
+    explicit Modifier(std::unique_ptr<Impl> impl) noexcept;
+
+    static std::vector<std::future<std::expected<Bytes, err_modifier>>>
+    submit_variants(std::shared_ptr<const Impl> base, std::vector<ModifierRecipe> recipes, ExecControl const &ctl,
+                    Executor &exec);
+
     std::unique_ptr<Impl> pimpl;
 };
 
 
+// Shape of a generated TrueType font. The same spec (incl. the seed) always produces the same font.
+struct SyntheticFontSpec {
+    uint32_t glyphCount       = 256; // Including .notdef, at most 65535
+    uint32_t contoursPerGlyph = 2;
+    uint32_t pointsPerContour = 8;   // At least 3
+
+    // Longest chain of composite glyphs referencing composite glyphs, 0 means no composite glyphs at all.
+    // When non-zero every 'compositeEvery'-th glyph is a composite.
+    uint32_t compositeDepth = 0;
+    uint32_t compositeEvery = 4;
+
+    // Codepoints are assigned to glyphs 1 .. glyphCount-1 in order, wrapping around if there are more codepoints
+    std::vector<CPRange> cmapRanges{{0x20, 0x7E}};
+
+    // Per glyph instructions plus 'fpgm', 'prep' and 'cvt ' tables
+    bool hinted = false;
+
+    uint16_t unitsPerEm = 1000;
+    uint32_t seed       = 1;
+};
+
+// Builds valid TTF fonts from scratch through otfcc. Meant for benchmarks and stress tests that cannot use real fonts.
+class OTFCCXX_API FontSynthesizer {
+public:
+    [[nodiscard]] static std::expected<Bytes, err_synth>
+    generate(SyntheticFontSpec const &spec, Options const &opts = otfccxx::Options(1, false));
+
+    // Ready made specs for typical worst cases
+    static SyntheticFontSpec
+    preset_latin();
+    static SyntheticFontSpec
+    preset_cjk(uint32_t glyphCount = 30000);
+    static SyntheticFontSpec
+    preset_deepComposites(uint32_t depth = 16);
+};
+
+
 class OTFCCXX_API Converter {
 public:
     static size_t
@@ -226,12 +934,87 @@ public:
     [[nodiscard]] static std::expected<Bytes, err_converter>
     encode_Woff2(ByteSpan ttf);
     [[nodiscard]] static std::expected<Bytes, err_converter>
+    encode_Woff2(FontSource const &src);
+    [[nodiscard]] static std::expected<Bytes, err_converter>
     decode_Woff2(ByteSpan ttf);
+    // The control is only checked before the compression starts
+    [[nodiscard]] static std::future<std::expected<Bytes, err_converter>>
+    encode_Woff2_async(FontSource src, ExecControl ctl = {}, Executor &exec = default_executor());
+
+    // Base64 (vectorized, the variant (AVX2, SSSE3 or scalar) is chosen at runtime)
+    // Exact length of the padded base64 encoding of 'byteCount' bytes
+    static constexpr size_t
+    base64_encodedSize(size_t byteCount) noexcept {
+        return ((byteCount + 2) / 3) * 4;
+    }
 
     [[nodiscard]] static std::expected<std::string, err_converter>
     encode_base64(ByteSpan bytes) noexcept;
     [[nodiscard]] static std::expected<Bytes, err_converter>
     decode_base64(std::string_view base64Encoded) noexcept;
+
+    // Writes exactly base64_encodedSize(bytes.size()) chars to the beginning of 'out'
+    [[nodiscard]] static std::expected<size_t, err_converter>
+    encode_base64_into(ByteSpan bytes, std::span<char> out) noexcept;
+    // Appends to 'out' with a single exact-size growth (ie. 'out' may already hold eg. a 'data:' prefix)
+    [[nodiscard]] static std::expected<size_t, err_converter>
+    encode_base64_append(ByteSpan bytes, std::string &out) noexcept;
+    [[nodiscard]] static std::expected<size_t, err_converter>
+    decode_base64_append(std::string_view base64Encoded, Bytes &out) noexcept;
+
+    // 'data:<mimeType>;base64,<...>' in one exact-size allocation
+    [[nodiscard]] static std::expected<std::string, err_converter>
+    encode_dataURI(ByteSpan bytes, std::string_view mimeType = "font/woff2") noexcept;
+
+    // Rebuilds the extended font from the font the client already holds and SubsetDelta::patch.
+    // The patch records the exact 'previous' it was made against, any other input is rejected (patch_baseMismatch).
+    [[nodiscard]] static std::expected<Bytes, err_converter>
+    apply_subsetPatch(ByteSpan previous, ByteSpan patch) noexcept;
+};
+
+
+// Chunked base64 encoding. Bytes not forming a complete 3 byte group are carried over to the next 'feed'.
+// The concatenation of all outputs equals Converter::encode_base64 of the concatenated input.
+class OTFCCXX_API Base64Encoder {
+public:
+    // Upper bound of the number of chars one 'feed' of 'chunkSize' bytes can produce
+    static constexpr size_t
+    max_feedOutputSize(size_t chunkSize) noexcept {
+        return ((chunkSize + 2) / 3) * 4;
+    }
+
+    [[nodiscard]] std::expected<size_t, err_converter>
+    feed(ByteSpan chunk, std::string &out) noexcept;
+    [[nodiscard]] std::expected<size_t, err_converter>
+    feed(ByteSpan chunk, std::span<char> out) noexcept;
+
+    // Flushes the carried over bytes (with padding) and resets the encoder
+    [[nodiscard]] std::expected<size_t, err_converter>
+    finish(std::string &out) noexcept;
+    [[nodiscard]] std::expected<size_t, err_converter>
+    finish(std::span<char> out) noexcept;
+
+private:
+    std::array<std::byte, 2> carry_{};
+    size_t                   carryLen_ = 0;
+};
+
+// Chunked base64 decoding. Chars not forming a complete quartet are carried over to the next 'feed'.
+// Padding is only valid in the very last quartet of the stream.
+class OTFCCXX_API Base64Decoder {
+public:
+    // A failure resets the decoder, the next 'feed' starts a new stream
+    [[nodiscard]] std::expected<size_t, err_converter>
+    feed(std::string_view chunk, Bytes &out) noexcept;
+
+    // Fails if the stream ended in the middle of a quartet. Resets the decoder.
+    [[nodiscard]] std::expected<size_t, err_converter>
+    finish(Bytes &out) noexcept;
+
+private:
+    std::array<char, 4> carry_{};
+    size_t              carryLen_ = 0;
+    bool                padded_   = false;
 };
 
 } // namespace otfccxx
\ No newline at end of file
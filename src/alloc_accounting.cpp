@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+
+#include <otfccxx/otfccxx.hpp>
+
+#include <otfccxx_private/machinery_alloc.hpp>
+
+
+#ifdef OTFCCXX_ALLOC_ACCOUNTING
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <malloc.h>
+#define OTFCCXX_NEW_API
+#else
+// Has to stay visible even when the shared library hides everything else
+#define OTFCCXX_NEW_API __attribute__((visibility("default")))
+#endif
+
+
+namespace {
+
+// Trivial type, so the thread_local needs no initialization guard (operator new may run before anything else)
+struct thread_counters {
+    uint64_t allocations;
+    uint64_t bytes;
+    uint32_t apiDepth;
+};
+thread_local thread_counters tl_counters{};
+
+void *
+counted_alloc(std::size_t n) noexcept {
+    tl_counters.allocations += 1;
+    tl_counters.bytes       += n;
+    return std::malloc(n ? n : 1);
+}
+void *
+counted_allocAligned(std::size_t n, std::align_val_t al) noexcept {
+    auto const align         = static_cast<std::size_t>(al);
+    tl_counters.allocations += 1;
+    tl_counters.bytes       += n;
+#ifdef _WIN32
+    return _aligned_malloc(n ? n : 1, align);
+#else
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return std::aligned_alloc(align, ((n ? n : 1) + align - 1) / align * align);
+#endif
+}
+void
+counted_freeAligned(void *p) noexcept {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+} // namespace
+
+
+// clang-format off
+OTFCCXX_NEW_API void *operator new(std::size_t n) {
+    if (void *p = counted_alloc(n)) { return p; }
+    throw std::bad_alloc();
+}
+OTFCCXX_NEW_API void *operator new[](std::size_t n) {
+    if (void *p = counted_alloc(n)) { return p; }
+    throw std::bad_alloc();
+}
+OTFCCXX_NEW_API void *operator new(std::size_t n, std::nothrow_t const &) noexcept { return counted_alloc(n); }
+OTFCCXX_NEW_API void *operator new[](std::size_t n, std::nothrow_t const &) noexcept { return counted_alloc(n); }
+
+OTFCCXX_NEW_API void *operator new(std::size_t n, std::align_val_t al) {
+    if (void *p = counted_allocAligned(n, al)) { return p; }
+    throw std::bad_alloc();
+}
+OTFCCXX_NEW_API void *operator new[](std::size_t n, std::align_val_t al) {
+    if (void *p = counted_allocAligned(n, al)) { return p; }
+    throw std::bad_alloc();
+}
+OTFCCXX_NEW_API void *operator new(std::size_t n, std::align_val_t al, std::nothrow_t const &) noexcept {
+    return counted_allocAligned(n, al);
+}
+OTFCCXX_NEW_API void *operator new[](std::size_t n, std::align_val_t al, std::nothrow_t const &) noexcept {
+    return counted_allocAligned(n, al);
+}
+
+OTFCCXX_NEW_API void operator delete(void *p) noexcept { std::free(p); }
+OTFCCXX_NEW_API void operator delete[](void *p) noexcept { std::free(p); }
+OTFCCXX_NEW_API void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+OTFCCXX_NEW_API void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+OTFCCXX_NEW_API void operator delete(void *p, std::nothrow_t const &) noexcept { std::free(p); }
+OTFCCXX_NEW_API void operator delete[](void *p, std::nothrow_t const &) noexcept { std::free(p); }
+
+OTFCCXX_NEW_API void operator delete(void *p, std::align_val_t) noexcept { counted_freeAligned(p); }
+OTFCCXX_NEW_API void operator delete[](void *p, std::align_val_t) noexcept { counted_freeAligned(p); }
+OTFCCXX_NEW_API void operator delete(void *p, std::size_t, std::align_val_t) noexcept { counted_freeAligned(p); }
+OTFCCXX_NEW_API void operator delete[](void *p, std::size_t, std::align_val_t) noexcept { counted_freeAligned(p); }
+OTFCCXX_NEW_API void operator delete(void *p, std::align_val_t, std::nothrow_t const &) noexcept {
+    counted_freeAligned(p);
+}
+OTFCCXX_NEW_API void operator delete[](void *p, std::align_val_t, std::nothrow_t const &) noexcept {
+    counted_freeAligned(p);
+}
+// clang-format on
+
+#endif
+
+
+namespace otfccxx {
+
+// #####################################################################
+// ### Allocation accounting implementation ###
+// #####################################################################
+
+#ifdef OTFCCXX_ALLOC_ACCOUNTING
+namespace {
+
+struct per_callTable {
+    std::mutex                  mtx;
+    std::vector<AllocCallStats> entries;
+};
+per_callTable &
+get_perCallTable() {
+    // Intentionally leaked, API calls may still finish during static destruction
+    static per_callTable *res = new per_callTable();
+    return *res;
+}
+
+} // namespace
+
+namespace detail {
+
+_allocScope::_allocScope(std::string_view const call) noexcept
+    : call_(call), start_(alloc_threadTotals()), outermost_(tl_counters.apiDepth == 0) {
+    tl_counters.apiDepth += 1;
+}
+
+_allocScope::~_allocScope() {
+    tl_counters.apiDepth -= 1;
+    if (not outermost_) { return; }
+
+    AllocStats const end = alloc_threadTotals();
+    try {
+        auto           &tbl = get_perCallTable();
+        std::lock_guard lock(tbl.mtx);
+
+        auto it = std::ranges::find(tbl.entries, call_, &AllocCallStats::call);
+        if (it == tbl.entries.end()) { it = tbl.entries.insert(it, AllocCallStats{call_}); }
+        it->calls             += 1;
+        it->total.allocations += end.allocations - start_.allocations;
+        it->total.bytes       += end.bytes - start_.bytes;
+    }
+    catch (...) {}
+}
+
+} // namespace detail
+
+bool
+alloc_accountingEnabled() noexcept {
+    return true;
+}
+AllocStats
+alloc_threadTotals() noexcept {
+    return AllocStats{tl_counters.allocations, tl_counters.bytes};
+}
+std::vector<AllocCallStats>
+alloc_perCall() {
+    auto           &tbl = get_perCallTable();
+    std::lock_guard lock(tbl.mtx);
+    return tbl.entries;
+}
+void
+alloc_reset() noexcept {
+    auto           &tbl = get_perCallTable();
+    std::lock_guard lock(tbl.mtx);
+    tbl.entries.clear();
+}
+
+#else
+bool
+alloc_accountingEnabled() noexcept {
+    return false;
+}
+AllocStats
+alloc_threadTotals() noexcept {
+    return AllocStats{};
+}
+std::vector<AllocCallStats>
+alloc_perCall() {
+    return {};
+}
+void
+alloc_reset() noexcept {}
+#endif
+
+} // namespace otfccxx
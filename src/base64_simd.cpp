@@ -0,0 +1,351 @@
+#include <array>
+#include <cstring>
+
+#include <otfccxx_private/base64_simd.hpp>
+
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OTFCCXX_B64_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && ! defined(__clang__)
+#include <intrin.h>
+#define OTFCCXX_B64_TARGET(x)
+#else
+#define OTFCCXX_B64_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+
+namespace otfccxx {
+namespace detail {
+namespace b64 {
+
+namespace {
+
+constexpr char enc_table[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+constexpr std::uint8_t dec_invalid = 0xFF;
+
+constexpr auto dec_table = []() {
+    std::array<std::uint8_t, 256> res{};
+    res.fill(dec_invalid);
+    for (std::uint8_t i = 0; i < 64; ++i) { res[static_cast<unsigned char>(enc_table[i])] = i; }
+    return res;
+}();
+
+
+// -------------------------------------------------
+// Scalar
+// -------------------------------------------------
+void
+encode_scalar(const std::uint8_t *src, std::size_t n, char *dst) noexcept {
+    std::size_t i = 0;
+    for (; i + 3 <= n; i += 3) {
+        std::uint32_t const v = (std::uint32_t{src[i]} << 16) | (std::uint32_t{src[i + 1]} << 8) | src[i + 2];
+        *dst++                = enc_table[(v >> 18) & 0x3F];
+        *dst++                = enc_table[(v >> 12) & 0x3F];
+        *dst++                = enc_table[(v >> 6) & 0x3F];
+        *dst++                = enc_table[v & 0x3F];
+    }
+    if (std::size_t const rem = n - i; rem == 1) {
+        std::uint32_t const v = std::uint32_t{src[i]} << 16;
+        *dst++                = enc_table[(v >> 18) & 0x3F];
+        *dst++                = enc_table[(v >> 12) & 0x3F];
+        *dst++                = '=';
+        *dst++                = '=';
+    }
+    else if (rem == 2) {
+        std::uint32_t const v = (std::uint32_t{src[i]} << 16) | (std::uint32_t{src[i + 1]} << 8);
+        *dst++                = enc_table[(v >> 18) & 0x3F];
+        *dst++                = enc_table[(v >> 12) & 0x3F];
+        *dst++                = enc_table[(v >> 6) & 0x3F];
+        *dst++                = '=';
+    }
+}
+
+// Decodes full quartets, the last one may carry '=' padding
+std::optional<std::size_t>
+decode_scalar(const char *src, std::size_t n, std::uint8_t *dst) noexcept {
+    if (n % 4 != 0) { return std::nullopt; }
+    std::uint8_t *const dstBeg = dst;
+
+    for (std::size_t i = 0; i < n; i += 4) {
+        auto const c0 = dec_table[static_cast<unsigned char>(src[i])];
+        auto const c1 = dec_table[static_cast<unsigned char>(src[i + 1])];
+        if (c0 == dec_invalid || c1 == dec_invalid) { return std::nullopt; }
+
+        bool const isLast = (i + 4 == n);
+        if (isLast && src[i + 2] == '=') {
+            if (src[i + 3] != '=') { return std::nullopt; }
+            *dst++ = static_cast<std::uint8_t>((c0 << 2) | (c1 >> 4));
+            break;
+        }
+        auto const c2 = dec_table[static_cast<unsigned char>(src[i + 2])];
+        if (c2 == dec_invalid) { return std::nullopt; }
+
+        if (isLast && src[i + 3] == '=') {
+            *dst++ = static_cast<std::uint8_t>((c0 << 2) | (c1 >> 4));
+            *dst++ = static_cast<std::uint8_t>((c1 << 4) | (c2 >> 2));
+            break;
+        }
+        auto const c3 = dec_table[static_cast<unsigned char>(src[i + 3])];
+        if (c3 == dec_invalid) { return std::nullopt; }
+
+        *dst++ = static_cast<std::uint8_t>((c0 << 2) | (c1 >> 4));
+        *dst++ = static_cast<std::uint8_t>((c1 << 4) | (c2 >> 2));
+        *dst++ = static_cast<std::uint8_t>((c2 << 6) | c3);
+    }
+    return static_cast<std::size_t>(dst - dstBeg);
+}
+
+
+#if defined(OTFCCXX_B64_X86)
+// -------------------------------------------------
+// SSSE3 (12 bytes -> 16 chars, 16 chars -> 12 bytes)
+// -------------------------------------------------
+// Classic 'multiply-shift + shuffle LUT' approach by W. Mula and D. Lemire.
+
+OTFCCXX_B64_TARGET("ssse3") inline __m128i
+enc_reshuffle_128(__m128i in) noexcept {
+    in               = _mm_shuffle_epi8(in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+    __m128i const t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+    __m128i const t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+    __m128i const t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+    __m128i const t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+    return _mm_or_si128(t1, t3);
+}
+
+OTFCCXX_B64_TARGET("ssse3") inline __m128i
+enc_translate_128(__m128i indices) noexcept {
+    __m128i const shiftLUT = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+                                           '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+    __m128i       res      = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+    __m128i const less     = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+    res                    = _mm_or_si128(res, _mm_and_si128(less, _mm_set1_epi8(13)));
+    res                    = _mm_shuffle_epi8(shiftLUT, res);
+    return _mm_add_epi8(res, indices);
+}
+
+OTFCCXX_B64_TARGET("ssse3") void
+encode_ssse3(const std::uint8_t *src, std::size_t n, char *dst) noexcept {
+    std::size_t i = 0;
+    // Each step reads 16 bytes but consumes only 12
+    for (; i + 16 <= n; i += 12, dst += 16) {
+        __m128i const in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), enc_translate_128(enc_reshuffle_128(in)));
+    }
+    encode_scalar(src + i, n - i, dst);
+}
+
+// Returns false if any of the 16 chars is outside of the base64 alphabet
+OTFCCXX_B64_TARGET("ssse3") inline bool
+dec_block_128(__m128i in, __m128i &out) noexcept {
+    __m128i const lutLo   = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B,
+                                          0x1B, 0x1B, 0x1A);
+    __m128i const lutHi   = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10,
+                                          0x10, 0x10, 0x10);
+    __m128i const lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m128i const mask2F  = _mm_set1_epi8(0x2F);
+
+    __m128i const hiNibbles = _mm_and_si128(_mm_srli_epi32(in, 4), mask2F);
+    __m128i const loNibbles = _mm_and_si128(in, mask2F);
+    __m128i const lo        = _mm_shuffle_epi8(lutLo, loNibbles);
+    __m128i const hi        = _mm_shuffle_epi8(lutHi, hiNibbles);
+    if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) { return false; }
+
+    __m128i const eq2F = _mm_cmpeq_epi8(in, mask2F);
+    __m128i const roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(eq2F, hiNibbles));
+    __m128i const vals = _mm_add_epi8(in, roll);
+
+    __m128i const mergedAB = _mm_maddubs_epi16(vals, _mm_set1_epi32(0x01400140));
+    __m128i const merged   = _mm_madd_epi16(mergedAB, _mm_set1_epi32(0x00011000));
+    out = _mm_shuffle_epi8(merged, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+    return true;
+}
+
+OTFCCXX_B64_TARGET("ssse3") std::optional<std::size_t>
+decode_ssse3(const char *src, std::size_t n, std::uint8_t *dst) noexcept {
+    if (n % 4 != 0) { return std::nullopt; }
+    std::uint8_t *const dstBeg = dst;
+    std::size_t         i      = 0;
+
+    // Keep at least 8 chars for the scalar tail so that the vector loop never sees padding and never stores past the
+    // end of 'dst' (16 byte store, 12 bytes used)
+    for (; i + 24 <= n; i += 16, dst += 12) {
+        __m128i out;
+        if (! dec_block_128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)), out)) { return std::nullopt; }
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), out);
+    }
+    auto const tail = decode_scalar(src + i, n - i, dst);
+    if (! tail.has_value()) { return std::nullopt; }
+    return static_cast<std::size_t>(dst - dstBeg) + tail.value();
+}
+
+
+// -------------------------------------------------
+// AVX2 (24 bytes -> 32 chars, 32 chars -> 24 bytes)
+// -------------------------------------------------
+OTFCCXX_B64_TARGET("avx2") void
+encode_avx2(const std::uint8_t *src, std::size_t n, char *dst) noexcept {
+    __m256i const shuf     = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1, 10, 11, 9, 10, 7, 8, 6,
+                                             7, 4, 5, 3, 4, 1, 2, 0, 1);
+    __m256i const shiftLUT = _mm256_setr_epi8(
+        'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+        '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+    std::size_t i = 0;
+    // Two 16 byte loads, each lane consumes 12 of them
+    for (; i + 28 <= n; i += 24, dst += 32) {
+        __m128i const lo = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m128i const hi = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 12));
+        __m256i       in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+        in               = _mm256_shuffle_epi8(in, shuf);
+        __m256i const t0 = _mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00));
+        __m256i const t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+        __m256i const t2 = _mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0));
+        __m256i const t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+        __m256i const ix = _mm256_or_si256(t1, t3);
+
+        __m256i       res  = _mm256_subs_epu8(ix, _mm256_set1_epi8(51));
+        __m256i const less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), ix);
+        res                = _mm256_or_si256(res, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+        res                = _mm256_add_epi8(_mm256_shuffle_epi8(shiftLUT, res), ix);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), res);
+    }
+    encode_ssse3(src + i, n - i, dst);
+}
+
+OTFCCXX_B64_TARGET("avx2") std::optional<std::size_t>
+decode_avx2(const char *src, std::size_t n, std::uint8_t *dst) noexcept {
+    if (n % 4 != 0) { return std::nullopt; }
+
+    __m256i const lutLo   = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A,
+                                             0x1B, 0x1B, 0x1B, 0x1A, 0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11,
+                                             0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+    __m256i const lutHi   = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10,
+                                             0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08,
+                                             0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+    __m256i const lutRoll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4,
+                                             -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+    __m256i const packLane = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5,
+                                              4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+    __m256i const mask2F   = _mm256_set1_epi8(0x2F);
+
+    std::uint8_t *const dstBeg = dst;
+    std::size_t         i      = 0;
+
+    // Same reasoning as in the SSSE3 variant (32 byte store, 24 bytes used)
+    for (; i + 48 <= n; i += 32, dst += 24) {
+        __m256i const in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+
+        __m256i const hiNibbles = _mm256_and_si256(_mm256_srli_epi32(in, 4), mask2F);
+        __m256i const loNibbles = _mm256_and_si256(in, mask2F);
+        __m256i const lo        = _mm256_shuffle_epi8(lutLo, loNibbles);
+        __m256i const hi        = _mm256_shuffle_epi8(lutHi, hiNibbles);
+        if (! _mm256_testz_si256(lo, hi)) { return std::nullopt; }
+
+        __m256i const eq2F = _mm256_cmpeq_epi8(in, mask2F);
+        __m256i const roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(eq2F, hiNibbles));
+        __m256i const vals = _mm256_add_epi8(in, roll);
+
+        __m256i const mergedAB = _mm256_maddubs_epi16(vals, _mm256_set1_epi32(0x01400140));
+        __m256i       out      = _mm256_madd_epi16(mergedAB, _mm256_set1_epi32(0x00011000));
+        out                    = _mm256_shuffle_epi8(out, packLane);
+        out                    = _mm256_permutevar8x32_epi32(out, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst), out);
+    }
+    auto const tail = decode_ssse3(src + i, n - i, dst);
+    if (! tail.has_value()) { return std::nullopt; }
+    return static_cast<std::size_t>(dst - dstBeg) + tail.value();
+}
+
+
+// -------------------------------------------------
+// Runtime dispatch
+// -------------------------------------------------
+enum class variant {
+    scalar,
+    ssse3,
+    avx2
+};
+
+variant
+detect_variant() noexcept {
+#if defined(_MSC_VER) && ! defined(__clang__)
+    int regs[4]{};
+    __cpuid(regs, 0);
+    int const maxLeaf = regs[0];
+    if (maxLeaf < 1) { return variant::scalar; }
+
+    __cpuid(regs, 1);
+    bool const has_ssse3  = (regs[2] & (1 << 9)) != 0;
+    bool const has_osxsav = (regs[2] & (1 << 27)) != 0;
+    bool const has_avx    = (regs[2] & (1 << 28)) != 0;
+
+    bool has_avx2 = false;
+    if (maxLeaf >= 7 && has_osxsav && has_avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(regs, 7, 0);
+        has_avx2 = (regs[1] & (1 << 5)) != 0;
+    }
+    if (has_avx2) { return variant::avx2; }
+    if (has_ssse3) { return variant::ssse3; }
+    return variant::scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { return variant::avx2; }
+    if (__builtin_cpu_supports("ssse3")) { return variant::ssse3; }
+    return variant::scalar;
+#endif
+}
+
+variant
+active() noexcept {
+    static variant const res = detect_variant();
+    return res;
+}
+#endif
+
+} // namespace
+
+
+void
+encode(const std::uint8_t *src, std::size_t n, char *dst) noexcept {
+#if defined(OTFCCXX_B64_X86)
+    switch (active()) {
+        case variant::avx2:  return encode_avx2(src, n, dst);
+        case variant::ssse3: return encode_ssse3(src, n, dst);
+        default:             break;
+    }
+#endif
+    encode_scalar(src, n, dst);
+}
+
+std::optional<std::size_t>
+decode(const char *src, std::size_t n, std::uint8_t *dst) noexcept {
+#if defined(OTFCCXX_B64_X86)
+    switch (active()) {
+        case variant::avx2:  return decode_avx2(src, n, dst);
+        case variant::ssse3: return decode_ssse3(src, n, dst);
+        default:             break;
+    }
+#endif
+    return decode_scalar(src, n, dst);
+}
+
+const char *
+active_variant() noexcept {
+#if defined(OTFCCXX_B64_X86)
+    switch (active()) {
+        case variant::avx2:  return "avx2";
+        case variant::ssse3: return "ssse3";
+        default:             break;
+    }
+#endif
+    return "scalar";
+}
+
+} // namespace b64
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,320 @@
+#include <array>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <utility>
+
+
+#include <otfccxx/otfccxx.hpp>
+
+#include <otfccxx_private/coverage_index_impl.hpp>
+#include <otfccxx_private/hash.hpp>
+#include <otfccxx_private/machinery_trace.hpp>
+#include <otfccxx_private/machinery_uptr.hpp>
+
+
+namespace otfccxx {
+
+namespace {
+namespace covidx = detail::covidx;
+
+template <typename T>
+T
+read_le(ByteSpan const data, size_t const offset) noexcept {
+    T res;
+    std::memcpy(&res, data.data() + offset, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) { res = std::byteswap(res); }
+    return res;
+}
+template <typename T>
+void
+put_le(Bytes &out, T v) {
+    if constexpr (std::endian::native == std::endian::big) { v = std::byteswap(v); }
+    auto const raw = std::bit_cast<std::array<std::byte, sizeof(T)>>(v);
+    out.insert(out.end(), raw.begin(), raw.end());
+}
+
+// Sorted inclusive ranges of the face's cmap
+std::optional<std::vector<CPRange>>
+scan_coverage(ByteSpan const data, uint32_t const faceIndex) {
+    hb_blob_uptr blob(hb_blob_create_or_fail(reinterpret_cast<const char *>(data.data()), data.size_bytes(),
+                                             HB_MEMORY_MODE_READONLY, nullptr, nullptr));
+    if (! blob) { return std::nullopt; }
+    hb_face_uptr face(hb_face_create_or_fail(blob.get(), faceIndex));
+    if (! face) { return std::nullopt; }
+
+    hb_set_uptr cps(hb_set_create());
+    hb_face_collect_unicodes(face.get(), cps.get());
+
+    std::vector<CPRange> res;
+    hb_codepoint_t       first = HB_SET_VALUE_INVALID, last = HB_SET_VALUE_INVALID;
+    while (hb_set_next_range(cps.get(), &first, &last)) { res.push_back(CPRange{first, last}); }
+    return res;
+}
+
+struct scanned_font {
+    covidx::entry        meta;
+    std::vector<CPRange> ranges;
+};
+
+Bytes
+serialize(std::span<const scanned_font> fonts) {
+    uint64_t rangeCount = 0;
+    Bytes    strings;
+    for (auto const &one : fonts) {
+        rangeCount += one.ranges.size();
+        auto const utf8 = one.meta.font.path.u8string();
+        strings.insert(strings.end(), reinterpret_cast<const std::byte *>(utf8.data()),
+                       reinterpret_cast<const std::byte *>(utf8.data() + utf8.size()));
+    }
+
+    Bytes body;
+    body.reserve(fonts.size() * covidx::entrySize + rangeCount * covidx::rangeSize + strings.size());
+    uint64_t firstRange = 0;
+    uint32_t pathOffset = 0;
+    for (auto const &one : fonts) {
+        auto const pathLength = static_cast<uint32_t>(one.meta.font.path.u8string().size());
+        put_le<uint64_t>(body, one.meta.contentHash);
+        put_le<uint64_t>(body, one.meta.fileSize);
+        put_le<int64_t>(body, one.meta.mtime);
+        put_le<uint64_t>(body, firstRange);
+        put_le<uint32_t>(body, static_cast<uint32_t>(one.ranges.size()));
+        put_le<uint32_t>(body, one.meta.font.faceIndex);
+        put_le<uint32_t>(body, pathOffset);
+        put_le<uint32_t>(body, pathLength);
+        body.push_back(static_cast<std::byte>(one.meta.font.group));
+        body.insert(body.end(), 7, std::byte{0});
+
+        firstRange += one.ranges.size();
+        pathOffset += pathLength;
+    }
+    for (auto const &one : fonts) {
+        for (auto const &rng : one.ranges) {
+            put_le<uint32_t>(body, rng.first);
+            put_le<uint32_t>(body, rng.last);
+        }
+    }
+    body.insert(body.end(), strings.begin(), strings.end());
+
+    Bytes res;
+    res.reserve(covidx::headerSize + body.size());
+    for (char const c : covidx::magic) { res.push_back(static_cast<std::byte>(c)); }
+    put_le<uint32_t>(res, covidx::version);
+    put_le<uint32_t>(res, static_cast<uint32_t>(fonts.size()));
+    put_le<uint64_t>(res, rangeCount);
+    put_le<uint64_t>(res, strings.size());
+    put_le<uint64_t>(res, detail::xxh64::hash(body));
+    put_le<uint64_t>(res, 0);
+    res.insert(res.end(), body.begin(), body.end());
+    return res;
+}
+
+// Validates all of 'data' and decodes the entries
+std::expected<std::vector<covidx::entry>, err_coverageIndex>
+parse(ByteSpan const data) {
+    if (data.size() < covidx::headerSize || std::memcmp(data.data(), covidx::magic, sizeof(covidx::magic)) != 0) {
+        return std::unexpected(err_coverageIndex::notAnIndex);
+    }
+    if (read_le<uint32_t>(data, 8) != covidx::version) {
+        return std::unexpected(err_coverageIndex::unsupportedVersion);
+    }
+
+    uint64_t const fontCount   = read_le<uint32_t>(data, 12);
+    uint64_t const rangeCount  = read_le<uint64_t>(data, 16);
+    uint64_t const stringBytes = read_le<uint64_t>(data, 24);
+    uint64_t const bodyHash    = read_le<uint64_t>(data, 32);
+
+    // Sizes are checked one section at a time, so that nothing can overflow
+    uint64_t const available = data.size() - covidx::headerSize;
+    if (fontCount > available / covidx::entrySize) { return std::unexpected(err_coverageIndex::dataCorrupted); }
+    uint64_t const entriesBytes = fontCount * covidx::entrySize;
+    if (rangeCount > (available - entriesBytes) / covidx::rangeSize) {
+        return std::unexpected(err_coverageIndex::dataCorrupted);
+    }
+    uint64_t const rangesBytes = rangeCount * covidx::rangeSize;
+    if (stringBytes != available - entriesBytes - rangesBytes) {
+        return std::unexpected(err_coverageIndex::dataCorrupted);
+    }
+    if (detail::xxh64::hash(data.subspan(covidx::headerSize)) != bodyHash) {
+        return std::unexpected(err_coverageIndex::dataCorrupted);
+    }
+
+    size_t const rangesAt  = covidx::headerSize + entriesBytes;
+    size_t const stringsAt = rangesAt + rangesBytes;
+    for (uint64_t i = 0; i < rangeCount; ++i) {
+        uint32_t const first = read_le<uint32_t>(data, rangesAt + i * covidx::rangeSize);
+        uint32_t const last  = read_le<uint32_t>(data, rangesAt + i * covidx::rangeSize + 4);
+        if (first > last || last > 0x10FFFF) { return std::unexpected(err_coverageIndex::dataCorrupted); }
+    }
+
+    std::vector<covidx::entry> res;
+    res.reserve(fontCount);
+    for (uint64_t i = 0; i < fontCount; ++i) {
+        size_t const at = covidx::headerSize + i * covidx::entrySize;
+
+        covidx::entry e;
+        e.contentHash             = read_le<uint64_t>(data, at);
+        e.fileSize                = read_le<uint64_t>(data, at + 8);
+        e.mtime                   = read_le<int64_t>(data, at + 16);
+        e.firstRange              = read_le<uint64_t>(data, at + 24);
+        e.rangeCount              = read_le<uint32_t>(data, at + 32);
+        e.font.faceIndex          = read_le<uint32_t>(data, at + 36);
+        uint64_t const pathOffset = read_le<uint32_t>(data, at + 40);
+        uint64_t const pathLength = read_le<uint32_t>(data, at + 44);
+        auto const     group      = std::to_integer<uint8_t>(data[at + 48]);
+
+        if (e.firstRange > rangeCount || e.rangeCount > rangeCount - e.firstRange ||
+            pathOffset + pathLength > stringBytes || group > std::to_underlying(WaterfallGroup::lastResort)) {
+            return std::unexpected(err_coverageIndex::dataCorrupted);
+        }
+        e.font.group = static_cast<WaterfallGroup>(group);
+
+        auto const *path = reinterpret_cast<const char8_t *>(data.data() + stringsAt + pathOffset);
+        e.font.path      = std::filesystem::path(std::u8string(path, pathLength));
+        res.push_back(std::move(e));
+    }
+    return res;
+}
+
+} // namespace
+
+
+// #####################################################################
+// ### CoverageIndex implementation ###
+// #####################################################################
+
+CPRange
+CoverageIndex::Impl::range(entry const &e, uint32_t const i) const noexcept {
+    size_t const at =
+        covidx::headerSize + entries.size() * covidx::entrySize + (e.firstRange + i) * covidx::rangeSize;
+    return CPRange{read_le<uint32_t>(data, at), read_le<uint32_t>(data, at + 4)};
+}
+
+
+CoverageIndex::CoverageIndex(std::shared_ptr<const Impl> impl) noexcept : pimpl(std::move(impl)) {}
+CoverageIndex::~CoverageIndex() = default;
+
+std::expected<CoverageIndex, err_coverageIndex>
+CoverageIndex::build(std::span<const CoverageFont> const fonts, CoverageIndex const *const previous) {
+    detail::_traceScope trace("coverageIndex.build");
+
+    std::map<std::pair<std::filesystem::path, uint32_t>, const Impl::entry *> reusable;
+    if (previous) {
+        for (auto const &e : previous->pimpl->entries) {
+            reusable.emplace(std::pair(e.font.path, e.font.faceIndex), &e);
+        }
+    }
+    auto const previousRanges = [&](Impl::entry const &e) {
+        std::vector<CPRange> res(e.rangeCount);
+        for (uint32_t i = 0; i < e.rangeCount; ++i) { res[i] = previous->pimpl->range(e, i); }
+        return res;
+    };
+
+    std::vector<scanned_font> scanned;
+    scanned.reserve(fonts.size());
+    for (auto const &font : fonts) {
+        std::error_code ec;
+        auto const      fileSize = std::filesystem::file_size(font.path, ec);
+        if (ec) { continue; }
+        auto const mtime = std::filesystem::last_write_time(font.path, ec);
+        if (ec) { continue; }
+
+        scanned_font one;
+        one.meta.font     = font;
+        one.meta.fileSize = fileSize;
+        one.meta.mtime    = static_cast<int64_t>(mtime.time_since_epoch().count());
+
+        auto const        prevIt = reusable.find(std::pair(font.path, font.faceIndex));
+        const Impl::entry *prev  = prevIt == reusable.end() ? nullptr : prevIt->second;
+
+        if (prev && prev->fileSize == one.meta.fileSize && prev->mtime == one.meta.mtime) {
+            one.meta.contentHash = prev->contentHash;
+            one.ranges           = previousRanges(*prev);
+        }
+        else {
+            auto exp_src = FontSource::from_file(font.path);
+            if (not exp_src.has_value()) { continue; }
+            one.meta.contentHash = exp_src->fingerprint();
+
+            if (prev && prev->contentHash == one.meta.contentHash) { one.ranges = previousRanges(*prev); }
+            else {
+                auto opt_ranges = scan_coverage(exp_src->bytes(), font.faceIndex);
+                if (not opt_ranges.has_value()) { continue; }
+                one.ranges = std::move(opt_ranges.value());
+            }
+        }
+        scanned.push_back(std::move(one));
+    }
+    if (scanned.size() > std::numeric_limits<uint32_t>::max()) {
+        return std::unexpected(err_coverageIndex::unknownError);
+    }
+
+    auto impl   = std::make_shared<Impl>();
+    impl->owned = serialize(scanned);
+    impl->data  = impl->owned;
+    auto exp_entries = parse(impl->data);
+    if (not exp_entries.has_value()) { return std::unexpected(exp_entries.error()); }
+    impl->entries = std::move(exp_entries.value());
+    trace.set_bytesOut(impl->data.size());
+    return CoverageIndex(std::move(impl));
+}
+
+std::expected<CoverageIndex, err_coverageIndex>
+CoverageIndex::open(std::filesystem::path const &pth) {
+    auto exp_mapped = detail::mapped_file::open(pth);
+    if (not exp_mapped.has_value()) {
+        return std::unexpected(exp_mapped.error() == err_fontSource::emptyData ? err_coverageIndex::notAnIndex
+                                                                                : err_coverageIndex::cannotOpenFile);
+    }
+
+    auto impl    = std::make_shared<Impl>();
+    impl->mapped = std::move(exp_mapped.value());
+    impl->data   = impl->mapped.bytes();
+    auto exp_entries = parse(impl->data);
+    if (not exp_entries.has_value()) { return std::unexpected(exp_entries.error()); }
+    impl->entries = std::move(exp_entries.value());
+    return CoverageIndex(std::move(impl));
+}
+
+std::expected<CoverageIndex, err_coverageIndex>
+CoverageIndex::refreshed() const {
+    std::vector<CoverageFont> fonts;
+    fonts.reserve(pimpl->entries.size());
+    for (auto const &e : pimpl->entries) { fonts.push_back(e.font); }
+    return build(fonts, this);
+}
+
+std::expected<size_t, err_write>
+CoverageIndex::write_toFile(std::filesystem::path const &pth) const {
+    return write_bytesToFile_atomic(pth, pimpl->data);
+}
+ByteSpan
+CoverageIndex::bytes() const noexcept {
+    return pimpl->data;
+}
+
+size_t
+CoverageIndex::font_count() const noexcept {
+    return pimpl->entries.size();
+}
+CoverageFont
+CoverageIndex::font(size_t const i) const {
+    if (i >= pimpl->entries.size()) { return CoverageFont{}; }
+    return pimpl->entries[i].font;
+}
+uint64_t
+CoverageIndex::content_hash(size_t const i) const noexcept {
+    if (i >= pimpl->entries.size()) { return 0; }
+    return pimpl->entries[i].contentHash;
+}
+std::vector<CPRange>
+CoverageIndex::coverage(size_t const i) const {
+    if (i >= pimpl->entries.size()) { return {}; }
+    auto const          &e = pimpl->entries[i];
+    std::vector<CPRange> res(e.rangeCount);
+    for (uint32_t r = 0; r < e.rangeCount; ++r) { res[r] = pimpl->range(e, r); }
+    return res;
+}
+
+} // namespace otfccxx
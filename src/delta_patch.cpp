@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <vector>
+
+#include <otfccxx_private/delta_patch.hpp>
+#include <otfccxx_private/hash.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace patch {
+
+namespace {
+
+void
+put_varint(Bytes &out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<std::byte>((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::byte>(v));
+}
+void
+put_u64(Bytes &out, std::uint64_t v) {
+    for (int i = 0; i < 8; ++i) { out.push_back(static_cast<std::byte>(v >> (i * 8))); }
+}
+
+// Reading side, every read fails (and stays failed) once the data runs out
+class reader {
+public:
+    explicit reader(ByteSpan data) : data_(data) {}
+
+    std::optional<std::uint64_t>
+    varint() noexcept {
+        std::uint64_t res = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= data_.size()) { return std::nullopt; }
+            auto const b  = std::to_integer<std::uint8_t>(data_[pos_++]);
+            res          |= std::uint64_t{b & 0x7Fu} << shift;
+            if ((b & 0x80) == 0) { return res; }
+        }
+        return std::nullopt;
+    }
+    std::optional<std::uint64_t>
+    u64() noexcept {
+        if (data_.size() - pos_ < 8) { return std::nullopt; }
+        std::uint64_t res = 0;
+        for (int i = 0; i < 8; ++i) { res |= std::uint64_t{std::to_integer<std::uint8_t>(data_[pos_ + i])} << (i * 8); }
+        pos_ += 8;
+        return res;
+    }
+    std::optional<ByteSpan>
+    bytes(std::uint64_t const n) noexcept {
+        if (data_.size() - pos_ < n) { return std::nullopt; }
+        ByteSpan const res = data_.subspan(pos_, n);
+        pos_              += n;
+        return res;
+    }
+    bool
+    at_end() const noexcept {
+        return pos_ == data_.size();
+    }
+
+private:
+    ByteSpan    data_;
+    std::size_t pos_ = 0;
+};
+
+// Hash of the 'minMatch' bytes at 'p' (only the first 8 go into the hash, the match is verified anyway)
+inline std::uint32_t
+window_hash(const std::byte *p, int const shift) noexcept {
+    std::uint64_t v;
+    std::memcpy(&v, p, sizeof(v));
+    return static_cast<std::uint32_t>((v * 0x9E3779B185EBCA87ull) >> shift);
+}
+
+} // namespace
+
+
+Bytes
+encode(ByteSpan const base, ByteSpan const target) {
+    Bytes res;
+    res.reserve(target.size() / 4 + 32);
+
+    for (char const c : magic) { res.push_back(static_cast<std::byte>(c)); }
+    put_varint(res, base.size());
+    put_u64(res, xxh64::hash(base));
+    put_varint(res, target.size());
+    put_u64(res, xxh64::hash(target));
+
+    // Index of base: window hash -> last position with that hash (+ 1, 0 is empty)
+    int const                  bits  = std::max(10, static_cast<int>(std::bit_width(base.size())));
+    int const                  shift = 64 - bits;
+    std::vector<std::uint32_t> index;
+    if (base.size() >= minMatch) {
+        index.assign(std::size_t{1} << bits, 0);
+        for (std::size_t i = 0; i + minMatch <= base.size(); ++i) {
+            index[window_hash(base.data() + i, shift)] = static_cast<std::uint32_t>(i + 1);
+        }
+    }
+
+    std::size_t litStart = 0;
+    std::size_t prevEnd  = 0; // End of the previous copy in base
+
+    auto const emit_literals = [&](std::size_t const end) {
+        if (end == litStart) { return; }
+        put_varint(res, (end - litStart) << 1);
+        auto const lit = target.subspan(litStart, end - litStart);
+        res.insert(res.end(), lit.begin(), lit.end());
+    };
+
+    std::size_t i = 0;
+    while (not index.empty() && i + minMatch <= target.size()) {
+        std::uint32_t const cand = index[window_hash(target.data() + i, shift)];
+        if (cand == 0) {
+            ++i;
+            continue;
+        }
+        std::size_t const from = cand - 1;
+        std::size_t       len  = 0;
+        std::size_t const most = std::min(base.size() - from, target.size() - i);
+        while (len < most && base[from + len] == target[i + len]) { ++len; }
+        if (len < minMatch) {
+            ++i;
+            continue;
+        }
+
+        // Grow the match backwards into the pending literals
+        std::size_t back = 0;
+        while (back < i - litStart && back < from && base[from - back - 1] == target[i - back - 1]) { ++back; }
+
+        emit_literals(i - back);
+        std::size_t const  copyFrom = from - back;
+        std::size_t const  copyLen  = len + back;
+        std::int64_t const delta    = static_cast<std::int64_t>(copyFrom) - static_cast<std::int64_t>(prevEnd);
+        put_varint(res, (copyLen << 1) | 1);
+        put_varint(res, (static_cast<std::uint64_t>(delta) << 1) ^ static_cast<std::uint64_t>(delta >> 63));
+
+        prevEnd  = copyFrom + copyLen;
+        i       += len;
+        litStart = i;
+    }
+    emit_literals(target.size());
+    return res;
+}
+
+std::expected<Bytes, decode_error>
+decode(ByteSpan const base, ByteSpan const patch) {
+    reader rd(patch);
+
+    auto const exp_magic = rd.bytes(sizeof(magic));
+    if (not exp_magic.has_value() || std::memcmp(exp_magic->data(), magic, sizeof(magic)) != 0) {
+        return std::unexpected(decode_error::dataInvalid);
+    }
+
+    auto const baseSize   = rd.varint();
+    auto const baseHash   = rd.u64();
+    auto const targetSize = rd.varint();
+    auto const targetHash = rd.u64();
+    if (not baseSize || not baseHash || not targetSize || not targetHash) {
+        return std::unexpected(decode_error::dataInvalid);
+    }
+    if (baseSize.value() != base.size() || baseHash.value() != xxh64::hash(base)) {
+        return std::unexpected(decode_error::baseMismatch);
+    }
+
+    Bytes res;
+    // 'targetSize' isn't trusted yet, it only goes into the reservation in a bounded way
+    res.reserve(std::min<std::uint64_t>(targetSize.value(), base.size() + patch.size()));
+    std::uint64_t prevEnd = 0;
+    while (res.size() < targetSize.value()) {
+        auto const op = rd.varint();
+        if (not op.has_value()) { return std::unexpected(decode_error::dataInvalid); }
+
+        std::uint64_t const len = op.value() >> 1;
+        if (len == 0 || len > targetSize.value() - res.size()) { return std::unexpected(decode_error::dataInvalid); }
+
+        if ((op.value() & 1) == 0) {
+            auto const lit = rd.bytes(len);
+            if (not lit.has_value()) { return std::unexpected(decode_error::dataInvalid); }
+            res.insert(res.end(), lit->begin(), lit->end());
+        }
+        else {
+            auto const zz = rd.varint();
+            if (not zz.has_value()) { return std::unexpected(decode_error::dataInvalid); }
+            std::int64_t const delta =
+                static_cast<std::int64_t>(zz.value() >> 1) ^ -static_cast<std::int64_t>(zz.value() & 1);
+            std::uint64_t const from = prevEnd + static_cast<std::uint64_t>(delta);
+            if (from > base.size() || len > base.size() - from) { return std::unexpected(decode_error::dataInvalid); }
+            res.insert(res.end(), base.begin() + from, base.begin() + from + len);
+            prevEnd = from + len;
+        }
+    }
+    if (not rd.at_end() || xxh64::hash(res) != targetHash.value()) {
+        return std::unexpected(decode_error::dataInvalid);
+    }
+    return res;
+}
+
+} // namespace patch
+} // namespace detail
+} // namespace otfccxx
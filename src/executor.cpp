@@ -0,0 +1,84 @@
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+
+// #####################################################################
+// ### ThreadPoolExecutor implementation ###
+// #####################################################################
+
+class ThreadPoolExecutor::Impl {
+public:
+    void
+    work() {
+        for (;;) {
+            std::move_only_function<void()> task;
+            {
+                std::unique_lock lock(mtx);
+                cv.wait(lock, [&]() { return stopping || not tasks.empty(); });
+                if (tasks.empty()) { return; }
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            try {
+                task();
+            }
+            catch (...) {
+                // A throwing task must not take the worker down with it
+            }
+        }
+    }
+
+    std::mutex                                  mtx;
+    std::condition_variable                     cv;
+    std::deque<std::move_only_function<void()>> tasks;
+    bool                                        stopping = false;
+
+    std::vector<std::thread> workers;
+};
+
+ThreadPoolExecutor::ThreadPoolExecutor(size_t threadCount) : pimpl(std::make_unique<Impl>()) {
+    if (threadCount == 0) { threadCount = std::max(1u, std::thread::hardware_concurrency()); }
+    pimpl->workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) { pimpl->workers.emplace_back([impl = pimpl.get()]() { impl->work(); }); }
+}
+
+ThreadPoolExecutor::~ThreadPoolExecutor() {
+    {
+        std::lock_guard lock(pimpl->mtx);
+        pimpl->stopping = true;
+    }
+    pimpl->cv.notify_all();
+    for (auto &w : pimpl->workers) { w.join(); }
+}
+
+void
+ThreadPoolExecutor::submit(std::move_only_function<void()> task) {
+    {
+        std::lock_guard lock(pimpl->mtx);
+        pimpl->tasks.push_back(std::move(task));
+    }
+    pimpl->cv.notify_one();
+}
+
+size_t
+ThreadPoolExecutor::thread_count() const noexcept {
+    return pimpl->workers.size();
+}
+
+Executor &
+default_executor() {
+    // Intentionally leaked, joining worker threads during static destruction is asking for trouble
+    static ThreadPoolExecutor *res = new ThreadPoolExecutor();
+    return *res;
+}
+
+} // namespace otfccxx
@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+namespace {
+
+// Unique (per process) suffix for temporary file names
+std::string
+make_tmpSuffix() {
+    static std::atomic<uint64_t> counter{0};
+#ifdef _WIN32
+    auto const pid = static_cast<unsigned long long>(GetCurrentProcessId());
+#else
+    auto const pid = static_cast<unsigned long long>(getpid());
+#endif
+    return ".tmp." + std::to_string(pid) + "." + std::to_string(counter.fetch_add(1, std::memory_order_relaxed));
+}
+
+
+#ifdef _WIN32
+// -------------------------------------------------
+// Windows
+// -------------------------------------------------
+std::expected<HANDLE, err_write>
+open_tmp(std::filesystem::path const &tmp) {
+    HANDLE h = CreateFileW(tmp.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (h == INVALID_HANDLE_VALUE) { return std::unexpected(err_write::cannotCreateTempFile); }
+    return h;
+}
+
+std::expected<size_t, err_write>
+write_atomic_impl(std::filesystem::path const &p, ByteSpan bytes, WriteOptions const &opts) {
+    std::filesystem::path tmp = p;
+    tmp += make_tmpSuffix();
+
+    auto exp_h = open_tmp(tmp);
+    if (not exp_h.has_value() && opts.createParentDirs && GetLastError() == ERROR_PATH_NOT_FOUND) {
+        std::error_code ec;
+        std::filesystem::create_directories(p.parent_path(), ec);
+        if (ec) { return std::unexpected(err_write::cannotCreateParentDirectory); }
+        exp_h = open_tmp(tmp);
+    }
+    if (not exp_h.has_value()) { return std::unexpected(exp_h.error()); }
+    HANDLE const h = exp_h.value();
+
+    auto const fail = [&](err_write const e) -> std::unexpected<err_write> {
+        CloseHandle(h);
+        DeleteFileW(tmp.c_str());
+        return std::unexpected(e);
+    };
+
+    // WriteFile takes a DWORD length, so anything above 4 GiB needs more than one call
+    const std::byte *cur  = bytes.data();
+    size_t           left = bytes.size();
+    while (left > 0) {
+        DWORD const toWrite = static_cast<DWORD>(std::min<size_t>(left, 0x40000000u));
+        DWORD       written = 0;
+        if (! WriteFile(h, cur, toWrite, &written, nullptr) || written == 0) { return fail(err_write::writeFailed); }
+        cur  += written;
+        left -= written;
+    }
+    if (opts.fsync && ! FlushFileBuffers(h)) { return fail(err_write::fsyncFailed); }
+    CloseHandle(h);
+
+    DWORD const flags = MOVEFILE_REPLACE_EXISTING | (opts.fsync ? MOVEFILE_WRITE_THROUGH : 0);
+    if (! MoveFileExW(tmp.c_str(), p.c_str(), flags)) {
+        DeleteFileW(tmp.c_str());
+        return std::unexpected(err_write::renameFailed);
+    }
+    return bytes.size();
+}
+
+#else
+// -------------------------------------------------
+// POSIX
+// -------------------------------------------------
+bool
+write_all(int fd, ByteSpan bytes) {
+    const std::byte *cur  = bytes.data();
+    size_t           left = bytes.size();
+    while (left > 0) {
+        ssize_t const written = ::write(fd, cur, left);
+        if (written < 0) {
+            if (errno == EINTR) { continue; }
+            return false;
+        }
+        cur  += written;
+        left -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool
+fsync_dir(std::filesystem::path const &dir) {
+    int const dfd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (dfd < 0) { return false; }
+    bool const ok = (::fsync(dfd) == 0);
+    ::close(dfd);
+    return ok;
+}
+
+// Opens a uniquely named temporary file next to 'p'. An anonymous O_TMPFILE would need /proc to get a name (and a
+// rename after linking it anyway), so it isn't used.
+int
+open_tmp(std::filesystem::path const &p, std::string &out_tmpName) {
+    out_tmpName = p.string() + make_tmpSuffix();
+    return ::open(out_tmpName.c_str(), O_CREAT | O_EXCL | O_WRONLY | O_CLOEXEC, 0666);
+}
+
+std::expected<size_t, err_write>
+write_atomic_impl(std::filesystem::path const &p, ByteSpan bytes, WriteOptions const &opts) {
+    std::string tmpName;
+
+    int fd = open_tmp(p, tmpName);
+    if (fd < 0 && errno == ENOENT && opts.createParentDirs && p.has_parent_path()) {
+        std::error_code ec;
+        std::filesystem::create_directories(p.parent_path(), ec);
+        if (ec) { return std::unexpected(err_write::cannotCreateParentDirectory); }
+        fd = open_tmp(p, tmpName);
+    }
+    if (fd < 0) { return std::unexpected(err_write::cannotCreateTempFile); }
+
+    auto const fail = [&](err_write const e) -> std::unexpected<err_write> {
+        ::close(fd);
+        ::unlink(tmpName.c_str());
+        return std::unexpected(e);
+    };
+
+    if (not write_all(fd, bytes)) { return fail(err_write::writeFailed); }
+    if (opts.fsync && ::fsync(fd) != 0) { return fail(err_write::fsyncFailed); }
+    ::close(fd);
+
+    if (::rename(tmpName.c_str(), p.c_str()) != 0) {
+        ::unlink(tmpName.c_str());
+        return std::unexpected(err_write::renameFailed);
+    }
+    if (opts.fsync && not fsync_dir(p.parent_path())) { return std::unexpected(err_write::fsyncFailed); }
+    return bytes.size();
+}
+#endif
+
+} // namespace
+
+
+std::expected<size_t, err_write>
+write_bytesToFile_atomic(std::filesystem::path const &p, ByteSpan bytes, WriteOptions const &opts) {
+    if (not p.has_filename()) { return std::unexpected(err_write::pathHasNoFilename); }
+    try {
+        return write_atomic_impl(p, bytes, opts);
+    }
+    catch (...) {
+        return std::unexpected(err_write::unknownError);
+    }
+}
+
+std::vector<std::expected<size_t, err_write>>
+write_bytesToFiles_atomic(std::span<const WriteJob> jobs, WriteOptions const &opts, size_t threadCount) {
+    std::vector<std::expected<size_t, err_write>> res(jobs.size(), std::unexpected(err_write::unknownError));
+    if (jobs.empty()) { return res; }
+
+    if (threadCount == 0) { threadCount = std::max(1u, std::thread::hardware_concurrency()); }
+    threadCount = std::min(threadCount, jobs.size());
+
+    std::atomic<size_t> next{0};
+    auto const          worker = [&]() {
+        for (size_t i = next.fetch_add(1, std::memory_order_relaxed); i < jobs.size();
+             i        = next.fetch_add(1, std::memory_order_relaxed)) {
+            res[i] = write_bytesToFile_atomic(jobs[i].path, jobs[i].bytes, opts);
+        }
+    };
+
+    {
+        std::vector<std::jthread> pool;
+        pool.reserve(threadCount - 1);
+        for (size_t i = 1; i < threadCount; ++i) { pool.emplace_back(worker); }
+        worker();
+    }
+    return res;
+}
+
+} // namespace otfccxx
@@ -0,0 +1,127 @@
+#include <cstdlib>
+#include <cstring>
+
+
+#include <otfccxx_private/font_copy.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace {
+
+// otfcc's 'copy' writes into uninitialized storage, 'free' later disposes and releases it with free()
+template <typename T, typename Interface>
+T *
+dup_table(Interface const &iface, const T *src) {
+    if (src == nullptr) { return nullptr; }
+    auto *res = static_cast<T *>(std::calloc(1, sizeof(T)));
+    if (res) { iface.copy(res, src); }
+    return res;
+}
+
+table_glyf *
+dup_glyf(const table_glyf *src) {
+    if (src == nullptr) { return nullptr; }
+    table_glyf *res = table_iGlyf.create();
+    if (res == nullptr) { return nullptr; }
+    for (size_t i = 0; i < src->length; ++i) { table_iGlyf.push(res, copy_glyph(src->items[i])); }
+    return res;
+}
+
+} // namespace
+
+
+// The glyph table only holds pointers and its 'copy' copies just those, so every glyph is duplicated here.
+// A glyph is copied as a whole first, then each member that owns memory gets its own copy.
+glyf_GlyphPtr
+copy_glyph(const glyf_Glyph *src) {
+    if (src == nullptr) { return nullptr; }
+    auto *res = static_cast<glyf_Glyph *>(std::malloc(sizeof(glyf_Glyph)));
+    if (res == nullptr) { return nullptr; }
+    std::memcpy(res, src, sizeof(glyf_Glyph));
+
+    res->name = src->name ? sdsdup(src->name) : nullptr;
+    iVQ.copy(&res->advanceWidth, &src->advanceWidth);
+    iVQ.copy(&res->advanceHeight, &src->advanceHeight);
+    iVQ.copy(&res->verticalOrigin, &src->verticalOrigin);
+
+    glyf_iContourList.copy(&res->contours, &src->contours);
+    glyf_iReferenceList.copy(&res->references, &src->references);
+    glyf_iStemDefList.copy(&res->stemH, &src->stemH);
+    glyf_iStemDefList.copy(&res->stemV, &src->stemV);
+    glyf_iMaskList.copy(&res->hintMasks, &src->hintMasks);
+    glyf_iMaskList.copy(&res->contourMasks, &src->contourMasks);
+    otfcc_iHandle.copy(&res->fdSelect, &src->fdSelect);
+
+    res->instructions = nullptr;
+    if (src->instructions != nullptr && src->instructionsLength > 0) {
+        res->instructions = static_cast<uint8_t *>(std::malloc(src->instructionsLength));
+        if (res->instructions) { std::memcpy(res->instructions, src->instructions, src->instructionsLength); }
+        else { res->instructionsLength = 0; }
+    }
+    return res;
+}
+
+otfcc_Font_uptr
+copy_font(otfcc_Font const &src) {
+    otfcc_Font_uptr res(otfcc_iFont.create());
+    if (not res) { return nullptr; }
+
+    res->subtype = src.subtype;
+    res->fvar    = dup_table(table_iFvar, src.fvar);
+    res->head    = dup_table(table_iHead, src.head);
+    res->hhea    = dup_table(table_iHhea, src.hhea);
+    res->maxp    = dup_table(table_iMaxp, src.maxp);
+    res->OS_2    = dup_table(table_iOS_2, src.OS_2);
+    res->hmtx    = dup_table(table_iHmtx, src.hmtx);
+    res->post    = dup_table(table_iPost, src.post);
+    res->hdmx    = dup_table(table_iHdmx, src.hdmx);
+    res->vhea    = dup_table(table_iVhea, src.vhea);
+    res->vmtx    = dup_table(table_iVmtx, src.vmtx);
+    res->VORG    = dup_table(table_iVORG, src.VORG);
+    res->CFF_    = dup_table(table_iCFF, src.CFF_);
+    res->glyf    = dup_glyf(src.glyf);
+    res->cmap    = dup_table(table_iCmap, src.cmap);
+    res->name    = dup_table(table_iName, src.name);
+    res->meta    = dup_table(table_iMeta, src.meta);
+    res->fpgm    = dup_table(table_iFpgm_prep, src.fpgm);
+    res->prep    = dup_table(table_iFpgm_prep, src.prep);
+    res->cvt_    = dup_table(table_iCvt, src.cvt_);
+    res->gasp    = dup_table(table_iGasp, src.gasp);
+    res->LTSH    = dup_table(table_iLTSH, src.LTSH);
+    res->GSUB    = dup_table(table_iOTL, src.GSUB);
+    res->GPOS    = dup_table(table_iOTL, src.GPOS);
+    res->GDEF    = dup_table(table_iGDEF, src.GDEF);
+    res->BASE    = dup_table(table_iBASE, src.BASE);
+    res->CPAL    = dup_table(table_iCPAL, src.CPAL);
+    res->COLR    = dup_table(table_iCOLR, src.COLR);
+    res->SVG_    = dup_table(table_iSVG, src.SVG_);
+    res->TSI_01  = dup_table(table_iTSI, src.TSI_01);
+    res->TSI_23  = dup_table(table_iTSI, src.TSI_23);
+    res->TSI5    = dup_table(table_iTSI, src.TSI5);
+
+    // Tables that failed to copy would silently go missing from the output
+    bool const complete =
+        (! src.fvar || res->fvar) && (! src.head || res->head) && (! src.hhea || res->hhea) &&
+        (! src.maxp || res->maxp) && (! src.OS_2 || res->OS_2) && (! src.hmtx || res->hmtx) &&
+        (! src.post || res->post) && (! src.hdmx || res->hdmx) && (! src.vhea || res->vhea) &&
+        (! src.vmtx || res->vmtx) && (! src.VORG || res->VORG) && (! src.CFF_ || res->CFF_) &&
+        (! src.glyf || res->glyf) && (! src.cmap || res->cmap) && (! src.name || res->name) &&
+        (! src.meta || res->meta) && (! src.fpgm || res->fpgm) && (! src.prep || res->prep) &&
+        (! src.cvt_ || res->cvt_) && (! src.gasp || res->gasp) && (! src.LTSH || res->LTSH) &&
+        (! src.GSUB || res->GSUB) && (! src.GPOS || res->GPOS) && (! src.GDEF || res->GDEF) &&
+        (! src.BASE || res->BASE) && (! src.CPAL || res->CPAL) && (! src.COLR || res->COLR) &&
+        (! src.SVG_ || res->SVG_) && (! src.TSI_01 || res->TSI_01) && (! src.TSI_23 || res->TSI_23) &&
+        (! src.TSI5 || res->TSI5);
+    if (not complete) { return nullptr; }
+
+    if (res->glyf) {
+        for (size_t i = 0; i < res->glyf->length; ++i) {
+            if (res->glyf->items[i] == nullptr && src.glyf->items[i] != nullptr) { return nullptr; }
+        }
+    }
+    return res;
+}
+
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,131 @@
+#include <cstdlib>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <otfccxx_private/font_copy.hpp>
+#include <otfccxx_private/font_merge.hpp>
+#include <otfccxx_private/glyph_closure.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace font_merge {
+
+namespace {
+
+// First name of the form 'name', 'name.m', 'name.m1', 'name.m2', ... that isn't taken yet, which it then is
+std::string
+claim_name(std::unordered_set<std::string> &taken, std::string name) {
+    if (taken.contains(name)) {
+        std::string const stem = name + ".m";
+        name                   = stem;
+        for (std::size_t i = 1; taken.contains(name); ++i) { name = stem + std::to_string(i); }
+    }
+    taken.insert(name);
+    return name;
+}
+
+} // namespace
+
+
+std::expected<std::size_t, error>
+append(otfcc_Font &base, otfcc_Font const &other) {
+    if (base.glyf == nullptr || other.glyf == nullptr || other.cmap == nullptr) { return 0uz; }
+    if (base.CFF_ != nullptr || other.CFF_ != nullptr) { return std::unexpected(error::cffOutlines); }
+    table_glyf const &src = *other.glyf;
+
+    // Codepoints only 'other' has, with the glyphs it maps them to
+    std::vector<CPRange>                     missing;
+    std::vector<std::pair<int, std::size_t>> mapped;
+    for (cmap_Entry const *e = other.cmap->unicodes; e != nullptr; e = static_cast<cmap_Entry const *>(e->hh.next)) {
+        if (e->unicode < 0) { continue; }
+        if (base.cmap != nullptr && table_iCmap.lookup(base.cmap, e->unicode) != nullptr) { continue; }
+        if (e->glyph.state != handle_state::HANDLE_STATE_CONSOLIDATED &&
+            e->glyph.state != handle_state::HANDLE_STATE_INDEX) { continue; }
+        if (e->glyph.index == 0 || e->glyph.index >= src.length) { continue; }
+        missing.push_back(CPRange{static_cast<std::uint32_t>(e->unicode), static_cast<std::uint32_t>(e->unicode)});
+        mapped.emplace_back(e->unicode, e->glyph.index);
+    }
+    if (missing.empty()) { return 0uz; }
+
+    // The layout tables of 'other' aren't merged, the glyphs only they reach would be dead weight
+    auto exp_keep = glyph_closure::reachable(other, missing, false);
+    if (not exp_keep.has_value()) {
+        switch (exp_keep.error()) {
+            case glyph_closure::error::missingGlyph:
+                return std::unexpected(error::missingGlyph);
+            case glyph_closure::error::handleNotIndex:
+                return std::unexpected(error::handleNotIndex);
+        }
+        std::unreachable();
+    }
+    std::vector<bool> &keep = exp_keep.value();
+    keep[0]                 = false; // 'base' has its own .notdef
+
+    std::unordered_set<std::string> taken;
+    taken.reserve(base.glyf->length + src.length);
+    for (std::size_t id = 0; id < base.glyf->length; ++id) {
+        glyf_Glyph const *g = base.glyf->items[id];
+        if (g != nullptr && g->name != nullptr) { taken.emplace(g->name, sdslen(g->name)); }
+    }
+    // A component can be the .notdef, which is base's then. An unnamed one gets the name it would have as a copy.
+    std::vector<std::string> names(src.length);
+    glyf_Glyph              *notdef = base.glyf->length > 0 ? base.glyf->items[0] : nullptr;
+    if (notdef != nullptr) {
+        names[0] = notdef->name != nullptr ? std::string(notdef->name, sdslen(notdef->name))
+                                           : claim_name(taken, "glyph0");
+    }
+    for (std::size_t id = 0; id < src.length; ++id) {
+        if (not keep[id]) { continue; }
+        glyf_Glyph const *g = src.items[id];
+        names[id] = claim_name(taken, g->name != nullptr ? std::string(g->name, sdslen(g->name))
+                                                         : "glyph" + std::to_string(id));
+    }
+
+    // Copies refer to each other by (the new) name, consolidation turns that into the new indices. All of them are
+    // made before 'base' is touched, running out of memory leaves it as it was.
+    std::vector<glyf_GlyphPtr> copies;
+    copies.reserve(src.length);
+    for (std::size_t id = 0; id < src.length; ++id) {
+        if (not keep[id]) { continue; }
+        glyf_GlyphPtr g = copy_glyph(src.items[id]);
+        if (g == nullptr) {
+            for (glyf_GlyphPtr const c : copies) { glyf_iGlyph.free(c); }
+            return std::unexpected(error::outOfMemory);
+        }
+        copies.push_back(g);
+
+        sdsfree(g->name);
+        g->name = sdsnewlen(names[id].data(), names[id].size());
+        for (std::size_t r = 0; r < g->references.length; ++r) {
+            otfcc_GlyphHandle &ref = g->references.items[r].glyph;
+            std::string const &to  = names[ref.index];
+            otfcc_iHandle.dispose(&ref);
+            ref = otfcc_iHandle.fromName(sdsnewlen(to.data(), to.size()));
+        }
+        if (g->instructions != nullptr) {
+            std::free(g->instructions);
+            g->instructions = nullptr;
+        }
+        g->instructionsLength = 0;
+    }
+
+    if (notdef != nullptr && notdef->name == nullptr) { notdef->name = sdsnewlen(names[0].data(), names[0].size()); }
+    for (glyf_GlyphPtr const g : copies) { table_iGlyf.push(base.glyf, g); }
+    if (base.cmap == nullptr) { base.cmap = table_iCmap.create(); }
+    for (auto const &[cp, id] : mapped) {
+        table_iCmap.encodeByName(base.cmap, cp, sdsnewlen(names[id].data(), names[id].size()));
+    }
+
+    if (base.glyph_order != nullptr) {
+        otfcc_pkgGlyphOrder.free(base.glyph_order);
+        base.glyph_order = nullptr;
+    }
+    return copies.size();
+}
+
+} // namespace font_merge
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,405 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <otfccxx_private/font_metrics.hpp>
+#include <otfccxx_private/machinery_parallel.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace font_metrics {
+
+namespace {
+
+// Glyphs per chunk of the parallel pass
+constexpr std::size_t grain = 512;
+
+constexpr double inf = std::numeric_limits<double>::infinity();
+
+struct bounds {
+    double xMin = inf;
+    double xMax = -inf;
+    double yMin = inf;
+    double yMax = -inf;
+
+    bool
+    empty() const noexcept {
+        return xMin > xMax;
+    }
+    void
+    add(double const x, double const y) noexcept {
+        xMin = std::min(xMin, x);
+        xMax = std::max(xMax, x);
+        yMin = std::min(yMin, y);
+        yMax = std::max(yMax, y);
+    }
+    void
+    add(bounds const &o) noexcept {
+        xMin = std::min(xMin, o.xMin);
+        xMax = std::max(xMax, o.xMax);
+        yMin = std::min(yMin, o.yMin);
+        yMax = std::max(yMax, o.yMax);
+    }
+};
+
+// Component placement, x' = a*x + b*y + dx, y' = c*x + d*y + dy (same as the transforms of Modifier)
+struct affine {
+    double a = 1, b = 0, c = 0, d = 1, dx = 0, dy = 0;
+
+    affine
+    then(affine const &outer) const noexcept {
+        return affine{outer.a * a + outer.b * c,
+                      outer.a * b + outer.b * d,
+                      outer.c * a + outer.d * c,
+                      outer.c * b + outer.d * d,
+                      outer.a * dx + outer.b * dy + outer.dx,
+                      outer.c * dx + outer.d * dy + outer.dy};
+    }
+    bool
+    axisAligned() const noexcept {
+        return b == 0 && c == 0;
+    }
+};
+
+struct measured {
+    bounds        box;
+    std::uint32_t nPoints      = 0; // Own outline
+    std::uint32_t nContours    = 0;
+    std::uint32_t flatPoints   = 0; // Incl. everything referenced, the same as the above for simple glyphs
+    std::uint32_t flatContours = 0;
+    std::uint16_t depth        = 0;
+    bool          composite    = false;
+    bool          anchored     = false; // A component somewhere below is placed by matching points
+
+    enum class state : std::uint8_t {
+        open,
+        inProgress,
+        done,
+    } st = state::open;
+};
+
+// The glyph's own outline. Branch free min/max accumulators, which the compiler turns into vector min/max over the
+// interleaved (x, y) pairs.
+void
+measure_outline(glyf_Glyph const &g, measured &m) noexcept {
+    double        xMin = inf, xMax = -inf, yMin = inf, yMax = -inf;
+    std::uint32_t nPoints = 0;
+    for (std::size_t c = 0; c < g.contours.length; ++c) {
+        glyf_Contour const &contour = g.contours.items[c];
+        for (std::size_t i = 0; i < contour.length; ++i) {
+            double const x = contour.items[i].x.kernel;
+            double const y = contour.items[i].y.kernel;
+            xMin           = std::min(xMin, x);
+            xMax           = std::max(xMax, x);
+            yMin           = std::min(yMin, y);
+            yMax           = std::max(yMax, y);
+        }
+        nPoints += static_cast<std::uint32_t>(contour.length);
+    }
+    m.box          = bounds{xMin, xMax, yMin, yMax};
+    m.nPoints      = nPoints;
+    m.nContours    = static_cast<std::uint32_t>(g.contours.length);
+    m.flatPoints   = m.nPoints;
+    m.flatContours = m.nContours;
+    m.composite    = g.references.length > 0;
+    m.st           = m.composite ? measured::state::open : measured::state::done;
+}
+
+// Resolves composites depth first, after all outlines were measured
+class composer {
+public:
+    composer(table_glyf const &glyf, std::vector<measured> &ms) : glyf_(glyf), ms_(ms) {}
+
+    std::expected<void, error>
+    solve(std::size_t const id) {
+        measured &m = ms_[id];
+        if (m.st == measured::state::done) { return {}; }
+        if (m.st == measured::state::inProgress) { return std::unexpected(error::cyclicReference); }
+        m.st = measured::state::inProgress;
+
+        glyf_Glyph const &g = *glyf_.items[id];
+        for (std::size_t r = 0; r < g.references.length; ++r) {
+            glyf_ComponentReference const &ref = g.references.items[r];
+            if (ref.glyph.state != handle_state::HANDLE_STATE_CONSOLIDATED &&
+                ref.glyph.state != handle_state::HANDLE_STATE_INDEX) {
+                return std::unexpected(error::handleNotIndex);
+            }
+            std::size_t const refID = ref.glyph.index;
+            if (refID >= glyf_.length || glyf_.items[refID] == nullptr) {
+                return std::unexpected(error::missingGlyph);
+            }
+            if (auto res = solve(refID); not res.has_value()) { return res; }
+
+            measured const &sub = ms_[refID];
+            add_placed(refID, placement(ref), m.box);
+            m.flatPoints   += sub.flatPoints;
+            m.flatContours += sub.flatContours;
+            m.depth         = std::max<std::uint16_t>(m.depth, sub.depth + 1);
+            m.anchored     |= ref.isAnchored || sub.anchored;
+        }
+        // Where anchored components end up depends on the points before them, the box comes from all the points then
+        if (m.anchored) {
+            std::vector<point> pts;
+            flatten(id, affine{}, pts);
+            m.box = bounds{};
+            for (point const &pt : pts) { m.box.add(pt.x, pt.y); }
+        }
+        m.st = measured::state::done;
+        return {};
+    }
+
+private:
+    struct point {
+        double x, y;
+    };
+
+    // Offsets only, anchored components get theirs from the points
+    static affine
+    placement(glyf_ComponentReference const &ref) noexcept {
+        if (ref.isAnchored) { return affine{ref.a, ref.b, ref.c, ref.d, 0, 0}; }
+        return affine{ref.a, ref.b, ref.c, ref.d, ref.x.kernel, ref.y.kernel};
+    }
+
+    // All points of the (solved) glyph 'id' in TrueType order (own contours, then the components in order) placed by
+    // 'tf'. An anchored component is moved so that its 'inner' point lands on the 'outer' point of what came before.
+    void
+    flatten(std::size_t const id, affine const &tf, std::vector<point> &out) const {
+        glyf_Glyph const &g     = *glyf_.items[id];
+        std::size_t const first = out.size();
+        for (std::size_t c = 0; c < g.contours.length; ++c) {
+            glyf_Contour const &contour = g.contours.items[c];
+            for (std::size_t i = 0; i < contour.length; ++i) {
+                double const x = contour.items[i].x.kernel;
+                double const y = contour.items[i].y.kernel;
+                out.push_back(point{tf.a * x + tf.b * y + tf.dx, tf.c * x + tf.d * y + tf.dy});
+            }
+        }
+        for (std::size_t r = 0; r < g.references.length; ++r) {
+            glyf_ComponentReference const &ref = g.references.items[r];
+            std::size_t const              at  = out.size();
+            flatten(ref.glyph.index, placement(ref).then(tf), out);
+            if (not ref.isAnchored) { continue; }
+
+            std::size_t const outer = first + ref.outer;
+            std::size_t const inner = at + ref.inner;
+            if (outer >= at || inner >= out.size()) { continue; } // Invalid anchors, left where they are
+            double const dx = out[outer].x - out[inner].x;
+            double const dy = out[outer].y - out[inner].y;
+            for (std::size_t i = at; i < out.size(); ++i) {
+                out[i].x += dx;
+                out[i].y += dy;
+            }
+        }
+    }
+
+    // Exact bounds of the (solved) glyph 'id' placed by 'tf'. Scaled and translated placements only need its box,
+    // rotated or skewed ones have to visit the points.
+    void
+    add_placed(std::size_t const id, affine const &tf, bounds &out) const {
+        measured const &sub = ms_[id];
+        if (sub.box.empty()) { return; }
+        if (tf.axisAligned()) {
+            out.add(tf.a * sub.box.xMin + tf.dx, tf.d * sub.box.yMin + tf.dy);
+            out.add(tf.a * sub.box.xMax + tf.dx, tf.d * sub.box.yMax + tf.dy);
+            return;
+        }
+        if (sub.anchored) {
+            std::vector<point> pts;
+            flatten(id, tf, pts);
+            for (point const &pt : pts) { out.add(pt.x, pt.y); }
+            return;
+        }
+
+        glyf_Glyph const &g = *glyf_.items[id];
+        for (std::size_t c = 0; c < g.contours.length; ++c) {
+            glyf_Contour const &contour = g.contours.items[c];
+            for (std::size_t i = 0; i < contour.length; ++i) {
+                double const x = contour.items[i].x.kernel;
+                double const y = contour.items[i].y.kernel;
+                out.add(tf.a * x + tf.b * y + tf.dx, tf.c * x + tf.d * y + tf.dy);
+            }
+        }
+        for (std::size_t r = 0; r < g.references.length; ++r) {
+            glyf_ComponentReference const &ref = g.references.items[r];
+            add_placed(ref.glyph.index, placement(ref).then(tf), out);
+        }
+    }
+
+    table_glyf const      &glyf_;
+    std::vector<measured> &ms_;
+};
+
+template <typename T>
+void
+set_rounded(T &out, double const v) noexcept {
+    out = static_cast<T>(std::lround(v));
+}
+std::uint16_t
+clamp16(std::uint32_t const v) noexcept {
+    return static_cast<std::uint16_t>(std::min<std::uint32_t>(v, 0xFFFF));
+}
+
+std::size_t
+rule_context(otl_ChainingRule const &rule) noexcept {
+    return rule.matchCount > rule.inputBegin ? rule.matchCount - rule.inputBegin : 0;
+}
+
+std::size_t
+lookup_context(otl_Lookup const &lookup) noexcept {
+    std::size_t res = 0;
+    for (std::size_t s = 0; s < lookup.subtables.length; ++s) {
+        otl_Subtable const *st = lookup.subtables.items[s];
+        if (st == nullptr) { continue; }
+        switch (lookup.type) {
+            case otl_type_gsub_single:
+            case otl_type_gsub_multiple:
+            case otl_type_gsub_alternate:
+            case otl_type_gpos_single: res = std::max<std::size_t>(res, 1); break;
+            case otl_type_gpos_pair: res = std::max<std::size_t>(res, 2); break;
+            case otl_type_gsub_ligature:
+                for (std::size_t i = 0; i < st->gsub_ligature.length; ++i) {
+                    otl_Coverage const *from = st->gsub_ligature.items[i].from;
+                    if (from != nullptr) { res = std::max<std::size_t>(res, from->numGlyphs); }
+                }
+                break;
+            case otl_type_gsub_context:
+            case otl_type_gsub_chaining:
+            case otl_type_gpos_context:
+            case otl_type_gpos_chaining: {
+                subtable_chaining const &ch = st->chaining;
+                if (ch.type == otl_chaining_canonic) {
+                    res = std::max(res, rule_context(ch.rule));
+                    break;
+                }
+                for (std::size_t r = 0; r < ch.rulesCount; ++r) {
+                    if (ch.rulePtrs[r] != nullptr) { res = std::max(res, rule_context(*ch.rulePtrs[r])); }
+                }
+                break;
+            }
+            case otl_type_gsub_reverse: {
+                auto const &rev = st->gsub_reverse;
+                if (rev.matchCount > rev.inputIndex) {
+                    res = std::max<std::size_t>(res, rev.matchCount - rev.inputIndex);
+                }
+                break;
+            }
+            default: break;
+        }
+    }
+    return res;
+}
+
+} // namespace
+
+
+std::expected<std::size_t, error>
+recompute(otfcc_Font &font, std::size_t const threadCount) {
+    if (font.glyf == nullptr) { return 0uz; }
+    table_glyf const &glyf = *font.glyf;
+
+    // Outlines of all glyphs, composites only get their own contours here
+    std::vector<measured> ms(glyf.length);
+    parallel_for(
+        glyf.length, grain,
+        [&](std::size_t const begin, std::size_t const end) {
+            for (std::size_t id = begin; id < end; ++id) {
+                if (glyf.items[id]) { measure_outline(*glyf.items[id], ms[id]); }
+                else { ms[id].st = measured::state::done; }
+            }
+        },
+        threadCount);
+
+    // Composites, usually a small part of the font
+    composer comp(glyf, ms);
+    for (std::size_t id = 0; id < glyf.length; ++id) {
+        if (auto res = comp.solve(id); not res.has_value()) { return std::unexpected(res.error()); }
+    }
+
+    // Write back and reduce to the font wide values
+    bounds        fontBox;
+    double        advanceWidthMax = 0, minLSB = inf, minRSB = inf, xMaxExtent = -inf;
+    std::uint32_t maxPoints = 0, maxContours = 0, maxCompositePoints = 0, maxCompositeContours = 0;
+    std::uint32_t maxComponentElements = 0, maxSizeOfInstructions = 0;
+    std::uint16_t maxComponentDepth = 0;
+    for (std::size_t id = 0; id < glyf.length; ++id) {
+        glyf_Glyph *g = glyf.items[id];
+        if (g == nullptr) { continue; }
+        measured const &m = ms[id];
+
+        bool const empty = m.box.empty();
+        set_rounded(g->stat.xMin, empty ? 0 : m.box.xMin);
+        set_rounded(g->stat.xMax, empty ? 0 : m.box.xMax);
+        set_rounded(g->stat.yMin, empty ? 0 : m.box.yMin);
+        set_rounded(g->stat.yMax, empty ? 0 : m.box.yMax);
+        g->stat.nestDepth          = m.depth;
+        g->stat.nPoints            = clamp16(m.nPoints);
+        g->stat.nContours          = clamp16(m.nContours);
+        g->stat.nCompositePoints   = m.composite ? clamp16(m.flatPoints) : 0;
+        g->stat.nCompositeContours = m.composite ? clamp16(m.flatContours) : 0;
+
+        double const advance = g->advanceWidth.kernel;
+        advanceWidthMax      = std::max(advanceWidthMax, advance);
+        if (not empty) {
+            fontBox.add(m.box);
+            minLSB     = std::min(minLSB, m.box.xMin);
+            minRSB     = std::min(minRSB, advance - m.box.xMax);
+            xMaxExtent = std::max(xMaxExtent, m.box.xMax);
+        }
+
+        if (m.composite) {
+            maxCompositePoints   = std::max(maxCompositePoints, m.flatPoints);
+            maxCompositeContours = std::max(maxCompositeContours, m.flatContours);
+            maxComponentElements = std::max(maxComponentElements, static_cast<std::uint32_t>(g->references.length));
+            maxComponentDepth    = std::max(maxComponentDepth, m.depth);
+        }
+        else {
+            maxPoints   = std::max(maxPoints, m.nPoints);
+            maxContours = std::max(maxContours, m.nContours);
+        }
+        maxSizeOfInstructions = std::max(maxSizeOfInstructions, g->instructionsLength);
+    }
+
+    bool const anyOutline = not fontBox.empty();
+    if (font.head) {
+        set_rounded(font.head->xMin, anyOutline ? fontBox.xMin : 0);
+        set_rounded(font.head->yMin, anyOutline ? fontBox.yMin : 0);
+        set_rounded(font.head->xMax, anyOutline ? fontBox.xMax : 0);
+        set_rounded(font.head->yMax, anyOutline ? fontBox.yMax : 0);
+    }
+    if (font.hhea) {
+        set_rounded(font.hhea->advanceWidthMax, advanceWidthMax);
+        set_rounded(font.hhea->minLeftSideBearing, anyOutline ? minLSB : 0);
+        set_rounded(font.hhea->minRightSideBearing, anyOutline ? minRSB : 0);
+        set_rounded(font.hhea->xMaxExtent, anyOutline ? xMaxExtent : 0);
+    }
+    if (font.maxp) {
+        font.maxp->numGlyphs             = clamp16(static_cast<std::uint32_t>(glyf.length));
+        font.maxp->maxPoints             = clamp16(maxPoints);
+        font.maxp->maxContours           = clamp16(maxContours);
+        font.maxp->maxCompositePoints    = clamp16(maxCompositePoints);
+        font.maxp->maxCompositeContours  = clamp16(maxCompositeContours);
+        font.maxp->maxComponentElements  = clamp16(maxComponentElements);
+        font.maxp->maxComponentDepth     = maxComponentDepth;
+        font.maxp->maxSizeOfInstructions = clamp16(maxSizeOfInstructions);
+    }
+    return glyf.length;
+}
+
+std::uint16_t
+max_context(table_OTL const *const gsub, table_OTL const *const gpos) noexcept {
+    std::size_t res = 0;
+    for (table_OTL const *otl : {gsub, gpos}) {
+        if (otl == nullptr) { continue; }
+        for (std::size_t l = 0; l < otl->lookups.length; ++l) {
+            if (otl->lookups.items[l] != nullptr) { res = std::max(res, lookup_context(*otl->lookups.items[l])); }
+        }
+    }
+    return static_cast<std::uint16_t>(std::min<std::size_t>(res, 0xFFFF));
+}
+
+} // namespace font_metrics
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,280 @@
+#include <utility>
+
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+#include <otfccxx/otfccxx.hpp>
+
+#include <otfccxx_private/font_source_impl.hpp>
+#include <otfccxx_private/hash.hpp>
+
+
+namespace otfccxx {
+
+// #####################################################################
+// ### mapped_file implementation ###
+// #####################################################################
+
+namespace detail {
+
+mapped_file::~mapped_file() {
+    reset();
+}
+
+mapped_file::mapped_file(mapped_file &&other) noexcept
+    : addr_(std::exchange(other.addr_, nullptr)), size_(std::exchange(other.size_, 0)) {
+#ifdef _WIN32
+    mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+}
+
+mapped_file &
+mapped_file::operator=(mapped_file &&other) noexcept {
+    if (this != &other) {
+        reset();
+        addr_ = std::exchange(other.addr_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+#ifdef _WIN32
+        mapping_ = std::exchange(other.mapping_, nullptr);
+#endif
+    }
+    return *this;
+}
+
+void
+mapped_file::reset() noexcept {
+#ifdef _WIN32
+    if (addr_) { UnmapViewOfFile(addr_); }
+    if (mapping_) { CloseHandle(mapping_); }
+    mapping_ = nullptr;
+#else
+    if (addr_) { ::munmap(addr_, size_); }
+#endif
+    addr_ = nullptr;
+    size_ = 0;
+}
+
+std::expected<mapped_file, err_fontSource>
+mapped_file::open(std::filesystem::path const &pth) {
+    mapped_file res;
+#ifdef _WIN32
+    HANDLE const file = CreateFileW(pth.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                    FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return std::unexpected(err_fontSource::cannotOpenFile); }
+
+    LARGE_INTEGER sz{};
+    if (! GetFileSizeEx(file, &sz)) {
+        CloseHandle(file);
+        return std::unexpected(err_fontSource::cannotOpenFile);
+    }
+    if (sz.QuadPart == 0) {
+        CloseHandle(file);
+        return std::unexpected(err_fontSource::emptyData);
+    }
+
+    res.mapping_ = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (! res.mapping_) { return std::unexpected(err_fontSource::cannotMapFile); }
+
+    res.addr_ = MapViewOfFile(res.mapping_, FILE_MAP_READ, 0, 0, 0);
+    if (! res.addr_) { return std::unexpected(err_fontSource::cannotMapFile); }
+    res.size_ = static_cast<size_t>(sz.QuadPart);
+#else
+    int const fd = ::open(pth.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) { return std::unexpected(err_fontSource::cannotOpenFile); }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || not S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return std::unexpected(err_fontSource::cannotOpenFile);
+    }
+    if (st.st_size == 0) {
+        ::close(fd);
+        return std::unexpected(err_fontSource::emptyData);
+    }
+
+    void *addr = ::mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping stays valid
+    if (addr == MAP_FAILED) { return std::unexpected(err_fontSource::cannotMapFile); }
+
+    res.addr_ = addr;
+    res.size_ = static_cast<size_t>(st.st_size);
+#endif
+    return res;
+}
+
+} // namespace detail
+
+
+// #####################################################################
+// ### FontSource implementation ###
+// #####################################################################
+
+namespace {
+
+constexpr uint32_t tag_ttcf = 0x74746366; // 'ttcf'
+constexpr uint32_t tag_true = 0x74727565; // 'true'
+constexpr uint32_t tag_OTTO = 0x4F54544F; // 'OTTO'
+
+uint32_t
+read_u32(ByteSpan data, size_t offset) noexcept {
+    return (std::to_integer<uint32_t>(data[offset]) << 24) | (std::to_integer<uint32_t>(data[offset + 1]) << 16) |
+           (std::to_integer<uint32_t>(data[offset + 2]) << 8) | std::to_integer<uint32_t>(data[offset + 3]);
+}
+uint16_t
+read_u16(ByteSpan data, size_t offset) noexcept {
+    return static_cast<uint16_t>((std::to_integer<uint32_t>(data[offset]) << 8) |
+                                 std::to_integer<uint32_t>(data[offset + 1]));
+}
+
+std::expected<std::vector<TableRecord>, err_fontSource>
+parse_tableDirectory(ByteSpan data, size_t const offset) {
+    if (offset + 12 > data.size()) { return std::unexpected(err_fontSource::tableDirectoryCorrupted); }
+
+    uint32_t const sfntVersion = read_u32(data, offset);
+    if (sfntVersion != 0x00010000u && sfntVersion != tag_true && sfntVersion != tag_OTTO) {
+        return std::unexpected(err_fontSource::notAnSFNT);
+    }
+
+    uint16_t const numTables = read_u16(data, offset + 4);
+    if (offset + 12 + size_t{numTables} * 16 > data.size()) {
+        return std::unexpected(err_fontSource::tableDirectoryCorrupted);
+    }
+
+    std::vector<TableRecord> res;
+    res.reserve(numTables);
+    for (size_t i = 0; i < numTables; ++i) {
+        size_t const      rec = offset + 12 + i * 16;
+        TableRecord const tr{read_u32(data, rec), read_u32(data, rec + 4), read_u32(data, rec + 8),
+                             read_u32(data, rec + 12)};
+        if (size_t{tr.offset} + tr.length > data.size()) {
+            return std::unexpected(err_fontSource::tableDirectoryCorrupted);
+        }
+        res.push_back(tr);
+    }
+    return res;
+}
+
+std::expected<std::vector<std::vector<TableRecord>>, err_fontSource>
+parse_faces(ByteSpan data) {
+    if (data.empty()) { return std::unexpected(err_fontSource::emptyData); }
+    if (data.size() < 12) { return std::unexpected(err_fontSource::notAnSFNT); }
+
+    std::vector<std::vector<TableRecord>> res;
+    if (read_u32(data, 0) == tag_ttcf) {
+        uint32_t const numFonts = read_u32(data, 8);
+        if (12 + size_t{numFonts} * 4 > data.size()) {
+            return std::unexpected(err_fontSource::tableDirectoryCorrupted);
+        }
+        res.reserve(numFonts);
+        for (uint32_t i = 0; i < numFonts; ++i) {
+            auto exp_dir = parse_tableDirectory(data, read_u32(data, 12 + size_t{i} * 4));
+            if (not exp_dir.has_value()) { return std::unexpected(exp_dir.error()); }
+            res.push_back(std::move(exp_dir.value()));
+        }
+    }
+    else {
+        auto exp_dir = parse_tableDirectory(data, 0);
+        if (not exp_dir.has_value()) { return std::unexpected(exp_dir.error()); }
+        res.push_back(std::move(exp_dir.value()));
+    }
+    return res;
+}
+
+} // namespace
+
+
+uint64_t
+FontSource::Impl::get_fingerprint() const {
+    std::call_once(fingerprint_once, [this]() { fingerprint = detail::xxh64::hash(data); });
+    return fingerprint;
+}
+
+
+FontSource::FontSource(std::shared_ptr<const Impl> impl) noexcept : pimpl(std::move(impl)) {}
+FontSource::~FontSource() = default;
+
+std::expected<FontSource, err_fontSource>
+FontSource::from_file(std::filesystem::path const &pth) {
+    auto exp_mapped = detail::mapped_file::open(pth);
+    if (not exp_mapped.has_value()) { return std::unexpected(exp_mapped.error()); }
+
+    auto impl    = std::make_shared<Impl>();
+    impl->mapped = std::move(exp_mapped.value());
+    impl->data   = impl->mapped.bytes();
+
+    auto exp_faces = parse_faces(impl->data);
+    if (not exp_faces.has_value()) { return std::unexpected(exp_faces.error()); }
+    impl->faces = std::move(exp_faces.value());
+    return FontSource(std::move(impl));
+}
+
+std::expected<FontSource, err_fontSource>
+FontSource::from_bytes(ByteSpan bytes) {
+    return from_bytes(Bytes(bytes.begin(), bytes.end()));
+}
+
+std::expected<FontSource, err_fontSource>
+FontSource::from_bytes(Bytes &&bytes) {
+    auto impl   = std::make_shared<Impl>();
+    impl->owned = std::move(bytes);
+    impl->data  = impl->owned;
+
+    auto exp_faces = parse_faces(impl->data);
+    if (not exp_faces.has_value()) { return std::unexpected(exp_faces.error()); }
+    impl->faces = std::move(exp_faces.value());
+    return FontSource(std::move(impl));
+}
+
+std::expected<FontSource, err_fontSource>
+FontSource::from_unownedBytes(ByteSpan bytes) {
+    auto impl  = std::make_shared<Impl>();
+    impl->data = bytes;
+
+    auto exp_faces = parse_faces(impl->data);
+    if (not exp_faces.has_value()) { return std::unexpected(exp_faces.error()); }
+    impl->faces = std::move(exp_faces.value());
+    return FontSource(std::move(impl));
+}
+
+ByteSpan
+FontSource::bytes() const noexcept {
+    return pimpl->data;
+}
+
+uint32_t
+FontSource::face_count() const noexcept {
+    return static_cast<uint32_t>(pimpl->faces.size());
+}
+
+std::span<const TableRecord>
+FontSource::table_directory(uint32_t faceIndex) const noexcept {
+    if (faceIndex >= pimpl->faces.size()) { return {}; }
+    return pimpl->faces[faceIndex];
+}
+
+std::optional<TableRecord>
+FontSource::find_table(uint32_t tag, uint32_t faceIndex) const noexcept {
+    for (auto const &rec : table_directory(faceIndex)) {
+        if (rec.tag == tag) { return rec; }
+    }
+    return std::nullopt;
+}
+
+uint64_t
+FontSource::fingerprint() const {
+    return pimpl->get_fingerprint();
+}
+
+} // namespace otfccxx
@@ -0,0 +1,333 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <numbers>
+#include <vector>
+
+
+#include <otfccxx/otfccxx.hpp>
+
+#include <otfccxx_private/machinery_alloc.hpp>
+#include <otfccxx_private/machinery_trace.hpp>
+#include <otfccxx_private/machinery_uptr.hpp>
+#include <otfccxx_private/options_impl.hpp>
+
+
+namespace otfccxx {
+namespace {
+
+// Small deterministic PRNG (splitmix64), the output must not depend on the standard library implementation
+class splitmix64 {
+public:
+    explicit splitmix64(uint64_t const seed) noexcept : state_(seed) {}
+
+    uint64_t
+    next() noexcept {
+        uint64_t z = (state_ += 0x9E3779B97F4A7C15ull);
+        z          = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z          = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    // Uniform in [lo, hi]
+    int32_t
+    next_inRange(int32_t const lo, int32_t const hi) noexcept {
+        return lo + static_cast<int32_t>(next() % static_cast<uint64_t>(hi - lo + 1));
+    }
+
+private:
+    uint64_t state_;
+};
+
+// TrueType instructions
+constexpr uint8_t ins_PUSHB_1  = 0xB0;
+constexpr uint8_t ins_MDAP_rnd = 0x2F;
+constexpr uint8_t ins_IUP_y    = 0x30;
+constexpr uint8_t ins_IUP_x    = 0x31;
+constexpr uint8_t ins_FDEF     = 0x2C;
+constexpr uint8_t ins_ENDF     = 0x2D;
+constexpr uint8_t ins_CALL     = 0x2B;
+
+uint8_t *
+make_instructions(std::initializer_list<uint8_t> const ins) {
+    // otfcc releases these with free()
+    auto *res = static_cast<uint8_t *>(std::malloc(ins.size()));
+    if (res) { std::memcpy(res, ins.begin(), ins.size()); }
+    return res;
+}
+
+glyf_Contour
+make_contour(splitmix64 &rng, uint32_t const pointCount, int32_t const cx, int32_t const cy, int32_t const radius) {
+    glyf_Contour res;
+    glyf_iContour.init(&res);
+    for (uint32_t i = 0; i < pointCount; ++i) {
+        double const  angle  = -2.0 * std::numbers::pi * i / pointCount; // clockwise, ie. an outer contour
+        int32_t const jitter = rng.next_inRange(-radius / 8, radius / 8);
+
+        glyf_Point pt{};
+        pt.x       = iVQ.createStill(std::round(cx + (radius + jitter) * std::cos(angle)));
+        pt.y       = iVQ.createStill(std::round(cy + (radius + jitter) * std::sin(angle)));
+        pt.onCurve = (i % 2 == 0);
+        glyf_iContour.push(&res, pt);
+    }
+    return res;
+}
+
+glyf_Glyph *
+make_simpleGlyph(splitmix64 &rng, SyntheticFontSpec const &spec, uint32_t const gid) {
+    glyf_Glyph   *res = glyf_iGlyph.create();
+    int32_t const upm = spec.unitsPerEm;
+
+    res->name         = gid == 0 ? sdsnew(".notdef") : sdscatprintf(sdsempty(), "g%u", gid);
+    res->advanceWidth = iVQ.createStill(rng.next_inRange(upm * 2 / 5, upm));
+
+    int32_t const maxRadius = std::max(upm / 8, 8);
+    for (uint32_t c = 0; c < spec.contoursPerGlyph; ++c) {
+        int32_t const radius = rng.next_inRange(maxRadius / 4, maxRadius);
+        int32_t const cx     = rng.next_inRange(radius, std::max(radius, upm / 2));
+        int32_t const cy     = rng.next_inRange(radius - upm / 5, upm * 7 / 10);
+        glyf_iContourList.push(&res->contours, make_contour(rng, spec.pointsPerContour, cx, cy, radius));
+    }
+
+    if (spec.hinted && spec.contoursPerGlyph > 0) {
+        // Touch the first point of every contour, then interpolate the rest
+        std::vector<uint8_t> ins;
+        for (uint32_t c = 0; c < spec.contoursPerGlyph; ++c) {
+            uint32_t const firstPt = c * spec.pointsPerContour;
+            if (firstPt > 0xFF) { break; }
+            ins.insert(ins.end(), {ins_PUSHB_1, static_cast<uint8_t>(firstPt), ins_MDAP_rnd});
+        }
+        ins.insert(ins.end(), {ins_IUP_y, ins_IUP_x});
+
+        res->instructions = static_cast<uint8_t *>(std::malloc(ins.size()));
+        if (res->instructions) {
+            std::memcpy(res->instructions, ins.data(), ins.size());
+            res->instructionsLength = static_cast<uint16_t>(ins.size());
+        }
+    }
+    return res;
+}
+
+glyf_Glyph *
+make_compositeGlyph(splitmix64 &rng, SyntheticFontSpec const &spec, uint32_t const gid,
+                    std::initializer_list<glyphid_t> const components) {
+    glyf_Glyph   *res = glyf_iGlyph.create();
+    int32_t const upm = spec.unitsPerEm;
+
+    res->name         = sdscatprintf(sdsempty(), "g%u", gid);
+    res->advanceWidth = iVQ.createStill(rng.next_inRange(upm * 2 / 5, upm));
+
+    for (glyphid_t const comp : components) {
+        glyf_ComponentReference ref;
+        glyf_iComponentReference.init(&ref);
+        ref.glyph = otfcc_iHandle.fromIndex(comp);
+        ref.x     = iVQ.createStill(rng.next_inRange(-upm / 20, upm / 20));
+        ref.y     = iVQ.createStill(rng.next_inRange(-upm / 20, upm / 20));
+        ref.a     = 1.0;
+        ref.b     = 0.0;
+        ref.c     = 0.0;
+        ref.d     = 1.0;
+        glyf_iReferenceList.push(&res->references, ref);
+    }
+    return res;
+}
+
+std::expected<bool, err_synth>
+validate(SyntheticFontSpec const &spec) {
+    if (spec.glyphCount == 0 || spec.glyphCount > 65535) { return std::unexpected(err_synth::glyphCountOutOfRange); }
+    if (spec.contoursPerGlyph > 0 && spec.pointsPerContour < 3) {
+        return std::unexpected(err_synth::pointsPerContourTooLow);
+    }
+    for (auto const &rng : spec.cmapRanges) {
+        if (rng.first > rng.last || rng.last > 0x10FFFF) { return std::unexpected(err_synth::cmapRangeInvalid); }
+    }
+    return true;
+}
+
+void
+fill_metricTables(otfcc_Font *font, SyntheticFontSpec const &spec) {
+    int32_t const upm = spec.unitsPerEm;
+
+    font->head->version     = 0x00010000;
+    font->head->magicNumber = 0x5F0F3CF5;
+    font->head->flags       = 0x000B;
+    font->head->unitsPerEm  = spec.unitsPerEm;
+
+    font->hhea->version        = 0x00010000;
+    font->hhea->ascender       = static_cast<int16_t>(upm * 4 / 5);
+    font->hhea->descender      = static_cast<int16_t>(-upm / 5);
+    font->hhea->lineGap        = 0;
+    font->hhea->caretSlopeRise = 1;
+
+    font->maxp->version = 0x00010000;
+    if (spec.hinted) {
+        font->maxp->maxZones         = 2;
+        font->maxp->maxFunctionDefs  = 1;
+        font->maxp->maxStackElements = 64;
+    }
+    else { font->maxp->maxZones = 1; }
+
+    font->OS_2->version        = 4;
+    font->OS_2->usWeightClass  = 400;
+    font->OS_2->usWidthClass   = 5;
+    font->OS_2->sTypoAscender  = static_cast<int16_t>(upm * 4 / 5);
+    font->OS_2->sTypoDescender = static_cast<int16_t>(-upm / 5);
+    font->OS_2->sTypoLineGap   = 0;
+    font->OS_2->usWinAscent    = static_cast<uint16_t>(upm * 4 / 5);
+    font->OS_2->usWinDescent   = static_cast<uint16_t>(upm / 5);
+
+    // No glyph names in 'post'
+    font->post->version = 0x00030000;
+
+    for (uint16_t const nameID : {1, 2, 4, 6}) {
+        otfcc_NameRecord rec{};
+        rec.platformID = 3;
+        rec.encodingID = 1;
+        rec.languageID = 0x0409;
+        rec.nameID     = nameID;
+        rec.nameString = sdsnew(nameID == 2 ? "Regular" : nameID == 6 ? "otfccxxSynthetic" : "otfccxx Synthetic");
+        table_iName.push(font->name, rec);
+    }
+}
+
+void
+fill_hintingTables(otfcc_Font *font) {
+    // fpgm defines function 0 (which does nothing), prep calls it
+    font->fpgm         = table_iFpgm_prep.create();
+    font->fpgm->tag    = sdsnew("fpgm");
+    font->fpgm->bytes  = make_instructions({ins_PUSHB_1, 0, ins_FDEF, ins_ENDF});
+    font->fpgm->length = font->fpgm->bytes ? 4 : 0;
+
+    font->prep         = table_iFpgm_prep.create();
+    font->prep->tag    = sdsnew("prep");
+    font->prep->bytes  = make_instructions({ins_PUSHB_1, 0, ins_CALL});
+    font->prep->length = font->prep->bytes ? 3 : 0;
+
+    constexpr uint32_t cvtCount = 16;
+    font->cvt_                  = table_iCvt.create();
+    font->cvt_->words           = static_cast<uint16_t *>(std::calloc(cvtCount, sizeof(uint16_t)));
+    font->cvt_->length          = font->cvt_->words ? cvtCount : 0;
+}
+
+} // namespace
+
+
+// #####################################################################
+// ### FontSynthesizer implementation ###
+// #####################################################################
+
+std::expected<Bytes, err_synth>
+FontSynthesizer::generate(SyntheticFontSpec const &spec, Options const &opts) {
+    detail::_allocScope allocs("FontSynthesizer::generate");
+    if (! opts.pimpl) { return std::unexpected(err_synth::unexpectedNullptr); }
+    if (auto exp_valid = validate(spec); not exp_valid.has_value()) { return std::unexpected(exp_valid.error()); }
+
+    detail::_traceScope trace("synthesizer.generate");
+    trace.set_glyphCount(spec.glyphCount);
+
+    otfcc_Font_uptr font(otfcc_iFont.create());
+    if (not font) { return std::unexpected(err_synth::unexpectedNullptr); }
+
+    font->subtype = FONTTYPE_TTF;
+    font->head    = table_iHead.create();
+    font->hhea    = table_iHhea.create();
+    font->maxp    = table_iMaxp.create();
+    font->OS_2    = table_iOS_2.create();
+    font->post    = table_iPost.create();
+    font->name    = table_iName.create();
+    font->cmap    = table_iCmap.create();
+    font->glyf    = table_iGlyf.create();
+    if (not font->head || not font->hhea || not font->maxp || not font->OS_2 || not font->post || not font->name ||
+        not font->cmap || not font->glyf) {
+        return std::unexpected(err_synth::unexpectedNullptr);
+    }
+    fill_metricTables(font.get(), spec);
+    if (spec.hinted) { fill_hintingTables(font.get()); }
+
+    // Glyphs
+    splitmix64               rng(spec.seed);
+    std::vector<uint32_t>    depth(spec.glyphCount, 0);
+    glyphid_t                lastSimple    = 0;
+    std::optional<glyphid_t> lastComposite = std::nullopt;
+
+    for (uint32_t gid = 0; gid < spec.glyphCount; ++gid) {
+        bool const makeComposite = spec.compositeDepth > 0 && gid > 1 &&
+                                   (spec.compositeEvery <= 1 || gid % spec.compositeEvery == 0);
+        if (not makeComposite) {
+            table_iGlyf.push(font->glyf, make_simpleGlyph(rng, spec, gid));
+            lastSimple = static_cast<glyphid_t>(gid);
+            continue;
+        }
+
+        // Extend the most recent chain until it reaches 'compositeDepth', then start a new one
+        glyphid_t const base = (lastComposite.has_value() && depth[lastComposite.value()] < spec.compositeDepth)
+                                   ? lastComposite.value()
+                                   : lastSimple;
+        depth[gid]           = depth[base] + 1;
+        table_iGlyf.push(font->glyf, base == lastSimple ? make_compositeGlyph(rng, spec, gid, {base})
+                                                        : make_compositeGlyph(rng, spec, gid, {base, lastSimple}));
+        lastComposite = static_cast<glyphid_t>(gid);
+    }
+
+    // Codepoints
+    if (spec.glyphCount > 1) {
+        uint32_t nextGid = 1;
+        for (auto const &range : spec.cmapRanges) {
+            for (uint32_t cp = range.first; cp <= range.last; ++cp) {
+                table_iCmap.encodeByIndex(font->cmap, cp, static_cast<glyphid_t>(nextGid));
+                nextGid = (nextGid + 1 < spec.glyphCount) ? nextGid + 1 : 1;
+            }
+        }
+    }
+
+    // Resolves glyph handles, builds the glyph order and computes 'maxp', 'hmtx', bounding boxes etc.
+    otfcc_iFont.consolidate(font.get(), opts.pimpl.get()->_opts.get());
+
+    otfcc_IFontSerializer *writer = otfcc_newOTFWriter();
+    caryll_Buffer         *otf    = (caryll_Buffer *)writer->serialize(font.get(), opts.pimpl.get()->_opts.get());
+    writer->free(writer);
+    if (! otf) { return std::unexpected(err_synth::serializationFailure); }
+
+    Bytes res(otf->size);
+    std::memcpy(res.data(), otf->data, otf->size);
+    buffree(otf);
+    trace.set_bytesOut(res.size());
+    return res;
+}
+
+SyntheticFontSpec
+FontSynthesizer::preset_latin() {
+    SyntheticFontSpec res;
+    res.glyphCount       = 600;
+    res.contoursPerGlyph = 2;
+    res.pointsPerContour = 24;
+    res.compositeDepth   = 1;
+    res.compositeEvery   = 5;
+    res.cmapRanges       = {{0x20, 0x7E}, {0xA0, 0x17F}, {0x2000, 0x206F}};
+    res.hinted           = true;
+    return res;
+}
+
+SyntheticFontSpec
+FontSynthesizer::preset_cjk(uint32_t glyphCount) {
+    SyntheticFontSpec res;
+    res.glyphCount       = glyphCount;
+    res.contoursPerGlyph = 6;
+    res.pointsPerContour = 16;
+    res.cmapRanges       = {{0x20, 0x7E}, {0x3000, 0x30FF}, {0x4E00, 0x9FFF}, {0xAC00, 0xD7A3}};
+    return res;
+}
+
+SyntheticFontSpec
+FontSynthesizer::preset_deepComposites(uint32_t depth) {
+    SyntheticFontSpec res;
+    res.glyphCount       = 2048;
+    res.contoursPerGlyph = 2;
+    res.pointsPerContour = 12;
+    res.compositeDepth   = depth;
+    res.compositeEvery   = 2;
+    res.cmapRanges       = {{0x20, 0x7E}, {0xA0, 0x7FF}};
+    return res;
+}
+
+} // namespace otfccxx
@@ -0,0 +1,257 @@
+#include <algorithm>
+#include <optional>
+#include <utility>
+
+#include <otfccxx_private/glyph_closure.hpp>
+#include <otfccxx_private/otfcc_enum.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace glyph_closure {
+
+namespace {
+
+// Sorted and merged copy of 'cps' for binary searching
+class cp_set {
+public:
+    explicit cp_set(std::span<const CPRange> const cps) : ranges_(cps.begin(), cps.end()) {
+        std::erase_if(ranges_, [](CPRange const &r) { return r.first > r.last; });
+        std::ranges::sort(ranges_, {}, &CPRange::first);
+
+        std::size_t w = 0;
+        for (std::size_t i = 0; i < ranges_.size(); ++i) {
+            if (w > 0 && ranges_[i].first <= ranges_[w - 1].last + 1ull) {
+                ranges_[w - 1].last = std::max(ranges_[w - 1].last, ranges_[i].last);
+            }
+            else { ranges_[w++] = ranges_[i]; }
+        }
+        ranges_.resize(w);
+    }
+
+    bool
+    contains(std::uint32_t const cp) const noexcept {
+        auto const it = std::ranges::upper_bound(ranges_, cp, {}, &CPRange::first);
+        return it != ranges_.begin() && cp <= std::prev(it)->last;
+    }
+
+private:
+    std::vector<CPRange> ranges_;
+};
+
+std::optional<std::size_t>
+index_of(otfcc_GlyphHandle const &h) noexcept {
+    if (h.state != handle_state::HANDLE_STATE_CONSOLIDATED && h.state != handle_state::HANDLE_STATE_INDEX) {
+        return std::nullopt;
+    }
+    return h.index;
+}
+
+class closure {
+public:
+    explicit closure(std::size_t const glyphCount) : keep_(glyphCount, false) {}
+
+    // Returns whether the glyph is new
+    bool
+    add(otfcc_GlyphHandle const &h) {
+        auto const id = index_of(h);
+        if (not id || *id >= keep_.size() || keep_[*id]) { return false; }
+        keep_[*id] = true;
+        pending_.push_back(*id);
+        return true;
+    }
+    bool
+    has(otfcc_GlyphHandle const &h) const noexcept {
+        auto const id = index_of(h);
+        return id && *id < keep_.size() && keep_[*id];
+    }
+    bool
+    has_all(otl_Coverage const *cov) const noexcept {
+        if (cov == nullptr) { return false; }
+        return std::ranges::all_of(std::span(cov->glyphs, cov->numGlyphs), [&](auto const &h) { return has(h); });
+    }
+    bool
+    add_all(otl_Coverage const *cov) {
+        if (cov == nullptr) { return false; }
+        bool grown = false;
+        for (auto const &h : std::span(cov->glyphs, cov->numGlyphs)) { grown |= add(h); }
+        return grown;
+    }
+
+    // Components of the glyphs added since the last call, recursively
+    std::expected<void, error>
+    add_components(table_glyf const &glyf) {
+        while (not pending_.empty()) {
+            std::size_t const id = pending_.back();
+            pending_.pop_back();
+            glyf_Glyph const *g = glyf.items[id];
+            if (g == nullptr) { continue; }
+            for (std::size_t r = 0; r < g->references.length; ++r) {
+                otfcc_GlyphHandle const &ref = g->references.items[r].glyph;
+                auto const               refID = index_of(ref);
+                if (not refID) { return std::unexpected(error::handleNotIndex); }
+                if (*refID >= glyf.length || glyf.items[*refID] == nullptr) {
+                    return std::unexpected(error::missingGlyph);
+                }
+                add(ref);
+            }
+        }
+        return {};
+    }
+
+    // One pass over all substitutions, returns whether anything was added
+    bool
+    add_substitutes(table_OTL const &gsub) {
+        bool grown = false;
+        for (std::size_t l = 0; l < gsub.lookups.length; ++l) {
+            otl_Lookup const *lookup = gsub.lookups.items[l];
+            if (lookup == nullptr) { continue; }
+            for (std::size_t s = 0; s < lookup->subtables.length; ++s) {
+                otl_Subtable const *st = lookup->subtables.items[s];
+                if (st != nullptr) { grown |= add_substitutes(lookup->type, *st); }
+            }
+        }
+        return grown;
+    }
+
+    // The layers of the reachable color glyphs, returns whether anything was added
+    bool
+    add_colorLayers(table_COLR const &colr) {
+        bool grown = false;
+        for (std::size_t m = 0; m < colr.length; ++m) {
+            colr_Mapping const &mapping = colr.items[m];
+            if (not has(mapping.glyph)) { continue; }
+            for (std::size_t l = 0; l < mapping.layers.length; ++l) { grown |= add(mapping.layers.items[l].glyph); }
+        }
+        return grown;
+    }
+
+    std::vector<bool>
+    release() && {
+        return std::move(keep_);
+    }
+
+private:
+    bool
+    add_substitutes(otl_LookupType const type, otl_Subtable const &st) {
+        bool grown = false;
+        switch (type) {
+            case otl_type_gsub_single:
+                for (std::size_t i = 0; i < st.gsub_single.length; ++i) {
+                    auto const &e = st.gsub_single.items[i];
+                    if (has(e.from)) { grown |= add(e.to); }
+                }
+                break;
+            case otl_type_gsub_multiple:
+            case otl_type_gsub_alternate:
+                for (std::size_t i = 0; i < st.gsub_multi.length; ++i) {
+                    auto const &e = st.gsub_multi.items[i];
+                    if (has(e.from)) { grown |= add_all(e.to); }
+                }
+                break;
+            case otl_type_gsub_ligature:
+                for (std::size_t i = 0; i < st.gsub_ligature.length; ++i) {
+                    auto const &e = st.gsub_ligature.items[i];
+                    if (has_all(e.from)) { grown |= add(e.to); }
+                }
+                break;
+            case otl_type_gsub_reverse: {
+                // 'to' runs parallel to the coverage of the input glyph
+                auto const &rev = st.gsub_reverse;
+                if (rev.match == nullptr || rev.inputIndex >= rev.matchCount || rev.to == nullptr) { break; }
+                otl_Coverage const *input = rev.match[rev.inputIndex];
+                if (input == nullptr) { break; }
+                std::size_t const n = std::min<std::size_t>(input->numGlyphs, rev.to->numGlyphs);
+                for (std::size_t i = 0; i < n; ++i) {
+                    if (has(input->glyphs[i])) { grown |= add(rev.to->glyphs[i]); }
+                }
+                break;
+            }
+            default:
+                // Contextual lookups substitute nothing themselves, the lookups they call are visited on their own
+                break;
+        }
+        return grown;
+    }
+
+    std::vector<bool>        keep_;
+    std::vector<std::size_t> pending_;
+};
+
+} // namespace
+
+
+std::expected<std::vector<bool>, error>
+reachable(otfcc_Font const &font, std::span<const CPRange> const cps, bool const followTables) {
+    if (font.glyf == nullptr) { return std::vector<bool>{}; }
+    table_glyf const &glyf = *font.glyf;
+    closure           res(glyf.length);
+
+    if (glyf.length > 0) {
+        otfcc_GlyphHandle notdef{};
+        notdef.state = handle_state::HANDLE_STATE_INDEX;
+        notdef.index = 0;
+        res.add(notdef);
+    }
+    if (font.cmap != nullptr) {
+        cp_set const wanted(cps);
+        for (cmap_Entry const *e = font.cmap->unicodes; e != nullptr; e = static_cast<cmap_Entry const *>(e->hh.next)) {
+            if (e->unicode >= 0 && wanted.contains(static_cast<std::uint32_t>(e->unicode))) { res.add(e->glyph); }
+        }
+    }
+
+    // Substitutes and color layers can be composites and composites can be substituted or colored, alternate until
+    // none of them adds a glyph
+    bool grown = false;
+    do {
+        if (auto r = res.add_components(glyf); not r.has_value()) { return std::unexpected(r.error()); }
+        if (not followTables) { break; }
+        grown = font.COLR != nullptr && res.add_colorLayers(*font.COLR);
+        if (font.GSUB != nullptr) { grown |= res.add_substitutes(*font.GSUB); }
+    } while (grown);
+    return std::move(res).release();
+}
+
+std::size_t
+retain(otfcc_Font &font, std::vector<bool> const &keep, std::span<const CPRange> const cps) {
+    if (font.glyf == nullptr) { return 0uz; }
+    table_glyf &glyf = *font.glyf;
+
+    if (font.cmap != nullptr) {
+        cp_set const     wanted(cps);
+        std::vector<int> unmapped;
+        for (cmap_Entry const *e = font.cmap->unicodes; e != nullptr; e = static_cast<cmap_Entry const *>(e->hh.next)) {
+            auto const id   = index_of(e->glyph);
+            bool const kept = id && *id < keep.size() && keep[*id];
+            if (not kept || e->unicode < 0 || not wanted.contains(static_cast<std::uint32_t>(e->unicode))) {
+                unmapped.push_back(e->unicode);
+            }
+        }
+        for (int const cp : unmapped) { table_iCmap.unmap(font.cmap, cp); }
+    }
+
+    // Compact in place, the survivors keep their order
+    std::size_t w = 0;
+    for (std::size_t id = 0; id < glyf.length; ++id) {
+        if (id < keep.size() && keep[id]) { glyf.items[w++] = glyf.items[id]; }
+        else if (glyf.items[id] != nullptr) { glyf_iGlyph.free(glyf.items[id]); }
+    }
+    glyf.length = w;
+
+    // Rebuilt from the glyph names by the next consolidation, which then resolves all handles against it
+    if (font.glyph_order != nullptr) {
+        otfcc_pkgGlyphOrder.free(font.glyph_order);
+        font.glyph_order = nullptr;
+    }
+
+    for (auto const tag : {otfcc_glyfTable_nameMapping::LTSH, otfcc_glyfTable_nameMapping::hdmx,
+                           otfcc_glyfTable_nameMapping::SVG, otfcc_glyfTable_nameMapping::TSI0,
+                           otfcc_glyfTable_nameMapping::TSI2, otfcc_glyfTable_nameMapping::TSI5}) {
+        otfcc_iFont.deleteTable(&font, std::to_underlying(tag));
+    }
+    return w;
+}
+
+} // namespace glyph_closure
+} // namespace detail
+} // namespace otfccxx
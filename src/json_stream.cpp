@@ -0,0 +1,176 @@
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <memory>
+
+#include <otfccxx_private/json_stream.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace json_stream {
+
+namespace {
+
+class writer {
+public:
+    writer(bool const pretty, std::function<void(std::string_view)> const &sink) : pretty_(pretty), sink_(sink) {}
+
+    void
+    value(json_value const &val) {
+        switch (val.type) {
+            case json_object:
+                {
+                    if (val.u.object.length == 0) {
+                        put("{}"sv);
+                        break;
+                    }
+                    put('{');
+                    ++depth_;
+                    for (unsigned int i = 0; i < val.u.object.length; ++i) {
+                        if (i > 0) { put(','); }
+                        newline();
+                        auto const &entry = val.u.object.values[i];
+                        string(std::string_view(entry.name, entry.name_length));
+                        put(pretty_ ? ": "sv : ":"sv);
+                        if (entry.value) { value(*entry.value); }
+                        else { put("null"sv); }
+                    }
+                    --depth_;
+                    newline();
+                    put('}');
+                    break;
+                }
+            case json_array:
+                {
+                    if (val.u.array.length == 0) {
+                        put("[]"sv);
+                        break;
+                    }
+                    put('[');
+                    ++depth_;
+                    for (unsigned int i = 0; i < val.u.array.length; ++i) {
+                        if (i > 0) { put(','); }
+                        newline();
+                        if (val.u.array.values[i]) { value(*val.u.array.values[i]); }
+                        else { put("null"sv); }
+                    }
+                    --depth_;
+                    newline();
+                    put(']');
+                    break;
+                }
+            case json_integer: number(val.u.integer); break;
+            case json_double:
+                if (std::isfinite(val.u.dbl)) { number(val.u.dbl); }
+                else { put("null"sv); }
+                break;
+            case json_string:  string(std::string_view(val.u.string.ptr, val.u.string.length)); break;
+            case json_boolean: put(val.u.boolean ? "true"sv : "false"sv); break;
+            case json_null:
+            case json_none:
+            default:           put("null"sv); break;
+        }
+    }
+
+    std::size_t
+    finish() {
+        flush();
+        return written_;
+    }
+
+private:
+    void
+    flush() {
+        if (used_ == 0) { return; }
+        sink_(std::string_view(buf_.data(), used_));
+        written_ += used_;
+        used_     = 0;
+    }
+
+    void
+    put(char const c) {
+        if (used_ == buf_.size()) { flush(); }
+        buf_[used_++] = c;
+    }
+    void
+    put(std::string_view sv) {
+        while (not sv.empty()) {
+            if (used_ == buf_.size()) { flush(); }
+            std::size_t const n = std::min(sv.size(), buf_.size() - used_);
+            std::memcpy(buf_.data() + used_, sv.data(), n);
+            used_ += n;
+            sv.remove_prefix(n);
+        }
+    }
+
+    void
+    newline() {
+        if (not pretty_) { return; }
+        put('\n');
+        for (std::size_t i = 0; i < depth_; ++i) { put("  "sv); }
+    }
+
+    template <typename T>
+    void
+    number(T const v) {
+        std::array<char, 32> tmp;
+        auto const [end, ec] = std::to_chars(tmp.data(), tmp.data() + tmp.size(), v);
+        put(std::string_view(tmp.data(), ec == std::errc{} ? end : tmp.data()));
+    }
+
+    // Runs of characters that need no escaping are copied at once, UTF-8 passes through unchanged
+    void
+    string(std::string_view sv) {
+        static constexpr char hex[] = "0123456789abcdef";
+        put('"');
+        std::size_t runStart = 0;
+        for (std::size_t i = 0; i < sv.size(); ++i) {
+            auto const c = static_cast<unsigned char>(sv[i]);
+            if (c >= 0x20 && c != '"' && c != '\\') { continue; }
+
+            put(sv.substr(runStart, i - runStart));
+            runStart = i + 1;
+            switch (c) {
+                case '"':  put("\\\""sv); break;
+                case '\\': put("\\\\"sv); break;
+                case '\b': put("\\b"sv); break;
+                case '\f': put("\\f"sv); break;
+                case '\n': put("\\n"sv); break;
+                case '\r': put("\\r"sv); break;
+                case '\t': put("\\t"sv); break;
+                default:
+                    put("\\u00"sv);
+                    put(hex[c >> 4]);
+                    put(hex[c & 0xF]);
+                    break;
+            }
+        }
+        put(sv.substr(runStart));
+        put('"');
+    }
+
+    bool                                         pretty_;
+    std::function<void(std::string_view)> const &sink_;
+    std::array<char, chunkSize>                  buf_;
+    std::size_t                                  used_    = 0;
+    std::size_t                                  written_ = 0;
+    std::size_t                                  depth_   = 0;
+};
+
+} // namespace
+
+
+std::size_t
+write(json_value const &root, bool const pretty, std::function<void(std::string_view)> const &sink) {
+    // The buffer is too big for the stack of every thread this may run on
+    auto w = std::make_unique<writer>(pretty, sink);
+    w->value(root);
+    return w->finish();
+}
+
+} // namespace json_stream
+} // namespace detail
+} // namespace otfccxx
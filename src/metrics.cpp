@@ -0,0 +1,255 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <format>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+
+#include <otfccxx/otfccxx.hpp>
+
+#include <otfccxx_private/machinery_metrics.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace metrics {
+namespace {
+
+struct definition {
+    std::string_view name;
+    std::string_view help;
+};
+
+constexpr size_t counterCount   = std::to_underlying(counter::_count);
+constexpr size_t histogramCount = std::to_underlying(histogram::_count);
+
+constexpr std::array<definition, counterCount> counterDefs{{
+    {"otfccxx_subsets_executed_total", "Subsetter executions that produced a result"},
+    {"otfccxx_subsets_failed_total", "Subsetter executions that failed"},
+    {"otfccxx_faces_touched_total", "Font faces subsetted or included as a whole"},
+    {"otfccxx_subset_bytes_out_total", "Bytes of font data produced by Subsetter"},
+    {"otfccxx_modifiers_parsed_total", "Fonts parsed by Modifier"},
+    {"otfccxx_parse_bytes_in_total", "Bytes of font data parsed by Modifier"},
+    {"otfccxx_exports_completed_total", "Fonts exported by Modifier"},
+    {"otfccxx_export_bytes_out_total", "Bytes of font data exported by Modifier"},
+    {"otfccxx_woff2_encodes_total", "WOFF2 compressions"},
+    {"otfccxx_woff2_encode_bytes_in_total", "Bytes of font data compressed to WOFF2"},
+    {"otfccxx_woff2_encode_bytes_out_total", "Bytes of WOFF2 data produced"},
+    {"otfccxx_woff2_decodes_total", "WOFF2 decompressions"},
+    {"otfccxx_delta_bytes_saved_total", "Bytes saved by incremental subset patches over full subsets"},
+    {"otfccxx_lazy_face_loads_total", "Lazily registered faces loaded (again) for subsetting"},
+    {"otfccxx_modifiers_cloned_total", "Modifiers created by copying an already parsed font"},
+}};
+constexpr std::array<definition, histogramCount> histogramDefs{{
+    {"otfccxx_faces_per_subset", "Font faces touched by one Subsetter execution"},
+    {"otfccxx_subset_latency_us", "Duration of Subsetter executions in microseconds"},
+    {"otfccxx_parse_latency_us", "Duration of Modifier font parsing in microseconds"},
+    {"otfccxx_export_latency_us", "Duration of Modifier exports in microseconds"},
+    {"otfccxx_woff2_encode_latency_us", "Duration of WOFF2 compressions in microseconds"},
+    {"otfccxx_woff2_compression_ratio_permille", "WOFF2 output size relative to input size, in permille"},
+}};
+
+// One per thread. Only the owning thread adds to it, snapshots and resets may run concurrently (relaxed atomics).
+struct shard {
+    using bucket_array = std::array<std::atomic<uint64_t>, MetricsHistogram::bucketCount>;
+
+    std::array<std::atomic<uint64_t>, counterCount>   counters{};
+    std::array<bucket_array, histogramCount>          buckets{};
+    std::array<std::atomic<uint64_t>, histogramCount> sums{};
+};
+
+void
+fold(shard &from, shard &into) noexcept {
+    for (size_t i = 0; i < counterCount; ++i) {
+        into.counters[i].fetch_add(from.counters[i].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    for (size_t h = 0; h < histogramCount; ++h) {
+        for (size_t b = 0; b < MetricsHistogram::bucketCount; ++b) {
+            into.buckets[h][b].fetch_add(from.buckets[h][b].exchange(0, std::memory_order_relaxed),
+                                         std::memory_order_relaxed);
+        }
+        into.sums[h].fetch_add(from.sums[h].exchange(0, std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+}
+
+void
+zero(shard &s) noexcept {
+    for (auto &c : s.counters) { c.store(0, std::memory_order_relaxed); }
+    for (auto &hist : s.buckets) {
+        for (auto &b : hist) { b.store(0, std::memory_order_relaxed); }
+    }
+    for (auto &sum : s.sums) { sum.store(0, std::memory_order_relaxed); }
+}
+
+// Live shards plus the totals of threads that already exited
+class registry {
+public:
+    static registry &
+    instance() {
+        // Intentionally leaked, thread_local shards of late exiting threads still detach from it
+        static registry *res = new registry();
+        return *res;
+    }
+
+    void
+    attach(shard *s) {
+        std::lock_guard lock(mtx);
+        live.push_back(s);
+    }
+    void
+    detach(shard *s) noexcept {
+        std::lock_guard lock(mtx);
+        fold(*s, retired);
+        std::erase(live, s);
+    }
+
+    std::mutex           mtx;
+    std::vector<shard *> live;
+    shard                retired;
+};
+
+struct shard_owner {
+    shard s;
+
+    shard_owner() { registry::instance().attach(&s); }
+    ~shard_owner() { registry::instance().detach(&s); }
+};
+
+shard &
+local_shard() {
+    thread_local shard_owner owner;
+    return owner.s;
+}
+
+} // namespace
+
+
+void
+add(counter const c, uint64_t const v) noexcept {
+    local_shard().counters[std::to_underlying(c)].fetch_add(v, std::memory_order_relaxed);
+}
+
+void
+observe(histogram const h, uint64_t const v) noexcept {
+    shard &s = local_shard();
+    s.buckets[std::to_underlying(h)][std::bit_width(v)].fetch_add(1, std::memory_order_relaxed);
+    s.sums[std::to_underlying(h)].fetch_add(v, std::memory_order_relaxed);
+}
+
+} // namespace metrics
+} // namespace detail
+
+
+// #####################################################################
+// ### Metrics snapshot and export ###
+// #####################################################################
+
+uint64_t
+MetricsHistogram::quantile(double q) const noexcept {
+    if (count == 0) { return 0; }
+    q                     = std::clamp(q, 0.0, 1.0);
+    uint64_t const target = std::max<uint64_t>(1, static_cast<uint64_t>(q * static_cast<double>(count) + 0.5));
+
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i < bucketCount; ++i) {
+        cumulative += buckets[i];
+        if (cumulative >= target) { return i == 0 ? 0 : (i == 64 ? UINT64_MAX : (uint64_t{1} << i) - 1); }
+    }
+    return UINT64_MAX;
+}
+
+std::optional<uint64_t>
+MetricsSnapshot::counter(std::string_view name) const noexcept {
+    for (auto const &c : counters) {
+        if (c.name == name) { return c.value; }
+    }
+    return std::nullopt;
+}
+
+const MetricsHistogram *
+MetricsSnapshot::histogram(std::string_view name) const noexcept {
+    for (auto const &h : histograms) {
+        if (h.name == name) { return &h; }
+    }
+    return nullptr;
+}
+
+std::string
+MetricsSnapshot::to_prometheus() const {
+    // Buckets up to 2^32 - 1 (over an hour in microseconds) are listed, anything above only shows in +Inf
+    constexpr size_t listedBuckets = 33;
+
+    std::string res;
+    auto        out = std::back_inserter(res);
+    for (auto const &c : counters) {
+        std::format_to(out, "# HELP {0} {1}\n# TYPE {0} counter\n{0} {2}\n", c.name, c.help, c.value);
+    }
+    for (auto const &h : histograms) {
+        std::format_to(out, "# HELP {0} {1}\n# TYPE {0} histogram\n", h.name, h.help);
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < listedBuckets; ++i) {
+            cumulative += h.buckets[i];
+            std::format_to(out, "{}_bucket{{le=\"{}\"}} {}\n", h.name, i == 0 ? 0 : (uint64_t{1} << i) - 1,
+                           cumulative);
+        }
+        std::format_to(out, "{0}_bucket{{le=\"+Inf\"}} {1}\n{0}_sum {2}\n{0}_count {1}\n", h.name, h.count, h.sum);
+    }
+    return res;
+}
+
+MetricsSnapshot
+metrics_snapshot() {
+    using namespace detail::metrics;
+
+    MetricsSnapshot res;
+    res.counters.reserve(counterCount);
+    res.histograms.reserve(histogramCount);
+    for (auto const &def : counterDefs) { res.counters.push_back(MetricsCounter{def.name, def.help}); }
+    for (auto const &def : histogramDefs) { res.histograms.push_back(MetricsHistogram{def.name, def.help}); }
+
+    auto const accumulate = [&](shard const &s) {
+        for (size_t i = 0; i < counterCount; ++i) {
+            res.counters[i].value += s.counters[i].load(std::memory_order_relaxed);
+        }
+        for (size_t h = 0; h < histogramCount; ++h) {
+            for (size_t b = 0; b < MetricsHistogram::bucketCount; ++b) {
+                uint64_t const v              = s.buckets[h][b].load(std::memory_order_relaxed);
+                res.histograms[h].buckets[b] += v;
+                res.histograms[h].count      += v;
+            }
+            res.histograms[h].sum += s.sums[h].load(std::memory_order_relaxed);
+        }
+    };
+
+    registry &reg = registry::instance();
+    {
+        std::lock_guard lock(reg.mtx);
+        accumulate(reg.retired);
+        for (shard const *s : reg.live) { accumulate(*s); }
+    }
+    return res;
+}
+
+void
+metrics_reset() noexcept {
+    using namespace detail::metrics;
+
+    registry       &reg = registry::instance();
+    std::lock_guard lock(reg.mtx);
+    zero(reg.retired);
+    for (shard *s : reg.live) { zero(*s); }
+}
+
+std::expected<size_t, err_write>
+metrics_writePrometheus(std::filesystem::path const &p) {
+    std::string const text = metrics_snapshot().to_prometheus();
+    return write_bytesToFile_atomic(p, std::as_bytes(std::span(text)));
+}
+
+} // namespace otfccxx
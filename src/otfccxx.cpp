@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <bit>
 #include <concepts>
 #include <cstdlib>
 #include <expected>
@@ -12,85 +14,73 @@
 #include <woff2/encode.h>
 #include <woff2/output.h>
 
-#include <base64.hpp>
-
 #include <otfccxx/otfccxx.hpp>
 
+#include <otfccxx_private/base64_simd.hpp>
+#include <otfccxx_private/coverage_index_impl.hpp>
+#include <otfccxx_private/delta_patch.hpp>
 #include <otfccxx_private/fmem_file.hpp>
+#include <otfccxx_private/font_copy.hpp>
+#include <otfccxx_private/font_merge.hpp>
+#include <otfccxx_private/font_metrics.hpp>
+#include <otfccxx_private/font_source_impl.hpp>
+#include <otfccxx_private/glyph_closure.hpp>
+#include <otfccxx_private/hash.hpp>
 #include <otfccxx_private/json_ext.hpp>
+#include <otfccxx_private/json_stream.hpp>
+#include <otfccxx_private/machinery_alloc.hpp>
+#include <otfccxx_private/machinery_exec.hpp>
+#include <otfccxx_private/machinery_metrics.hpp>
+#include <otfccxx_private/machinery_parallel.hpp>
 #include <otfccxx_private/machinery_stderr_capt.hpp>
+#include <otfccxx_private/machinery_trace.hpp>
+#include <otfccxx_private/options_impl.hpp>
 #include <otfccxx_private/otfcc_enum.hpp>
 #include <otfccxx_private/otfcc_iVector.hpp>
+#include <otfccxx_private/sfnt_tables.hpp>
+#include <otfccxx_private/table_profile.hpp>
+#include <otfccxx_private/utf_simd.hpp>
 
 
 namespace otfccxx {
 using namespace std::literals;
 
-struct AccessInfo {
-    bool readable;
-    bool writable;
-};
-
-static std::expected<AccessInfo, std::filesystem::file_type>
-check_access(const std::filesystem::path &p) {
-    namespace fs = std::filesystem;
-    std::error_code ec;
-
-    // Resolve symlink (follows by default)
-    auto ft = fs::status(p, ec).type();
-    if (ec || ft == fs::file_type::not_found) { return std::unexpected(fs::file_type::not_found); }
-
-    // Only allow normal files and directories
-    if (ft != fs::file_type::regular && ft != fs::file_type::directory) { return std::unexpected(ft); }
-
-    AccessInfo res{false, false};
-
-    // ---- Regular file ----
-    if (ft == fs::file_type::regular) {
-        res.readable = std::ifstream(p).good();
-        res.writable = std::ofstream(p, std::ios::app).good();
-    }
-
-    // ---- Directory ----
-    else if (ft == fs::file_type::directory) {
-        // Check directory readability by attempting to iterate
-        fs::directory_iterator it(p, ec);
-        res.readable = ! ec;
-
-        // Check directory writability by trying to create a temp file
-        auto          testfile = p / ".fs_test.tmp";
-        std::ofstream ofs(testfile);
-        if (ofs.good()) {
-            res.writable = true;
-            ofs.close();
-            fs::remove(testfile, ec);
-        }
-    }
+namespace {
+// Only used for tracing, hb_face_reference_blob doesn't copy
+uint64_t
+hb_face_byteSize(hb_face_t *face) {
+    hb_blob_uptr blob(hb_face_reference_blob(face));
+    return hb_blob_get_length(blob.get());
+}
 
+// Modifier snapshot layout (integers little endian):
+//   "OXMS", u32 version, u64 source fingerprint, u64 sfntSize, u64 xxh64(sfnt)
+//   sfnt    the consolidated font as written by otfcc without optimizations
+namespace snapshot_fmt {
+constexpr char     magic[4]   = {'O', 'X', 'M', 'S'};
+constexpr uint32_t version    = 1;
+constexpr size_t   headerSize = 32;
+
+void
+put_le(Bytes &out, uint64_t const v, size_t const bytes) {
+    for (size_t i = 0; i < bytes; ++i) { out.push_back(static_cast<std::byte>(v >> (i * 8))); }
+}
+uint64_t
+read_le(ByteSpan const data, size_t const offset, size_t const bytes) {
+    uint64_t res = 0;
+    for (size_t i = 0; i < bytes; ++i) { res |= uint64_t{std::to_integer<uint8_t>(data[offset + i])} << (i * 8); }
     return res;
 }
+} // namespace snapshot_fmt
+} // namespace
 
 std::expected<bool, std::filesystem::file_type>
 write_bytesToFile(std::filesystem::path const &p, ByteSpan bytes) {
     if (not p.has_filename()) { return std::unexpected(std::filesystem::file_type::not_found); }
-    if (p.has_parent_path()) {
-        std::error_code ec;
-        std::filesystem::create_directories(p.parent_path(), ec);
-        if (ec) { return false; }
-    }
-    else { return std::unexpected(std::filesystem::file_type::not_found); }
+    if (not p.has_parent_path()) { return std::unexpected(std::filesystem::file_type::not_found); }
 
-    if (auto exp_accInfo = check_access(p.parent_path()); not exp_accInfo.has_value()) {
-        return std::unexpected(exp_accInfo.error());
-    }
-    else if (not exp_accInfo.value().writable) { return false; }
-
-    std::ofstream outs(p, std::ios::binary);
-    if (! outs) { return false; }
-
-    outs.write(reinterpret_cast<const char *>(bytes.data()), static_cast<std::streamsize>(bytes.size_bytes()));
-    outs.flush();
-    return outs.good();
+    // No up-front access probing, the write itself tells us whether the directory is writable
+    return write_bytesToFile_atomic(p, bytes).has_value();
 }
 
 
@@ -98,29 +88,20 @@ write_bytesToFile(std::filesystem::path const &p, ByteSpan bytes) {
 // ### Options implementaion ###
 // #####################################################################
 
-class Options::Impl {
-    friend class Modifier;
-
-public:
-    Impl() : _opts(otfcc_newOptions()) {}
-    Impl(uint8_t const optLevel, bool const removeTTFhints) : _opts(otfcc_newOptions()) {
-        otfcc_Options_optimizeTo(_opts.get(), optLevel);
-        _opts->logger = otfcc_newLogger(otfcc_newStdErrTarget());
-        _opts->logger->indent(_opts->logger, "[missing]");
-        _opts->decimal_cmap = true;
-        _opts->ignore_hints = removeTTFhints;
-    }
-
-private:
-    otfcc_opt_uptr _opts;
-};
-
-
 Options::Options() noexcept : pimpl(std::make_unique<Impl>()) {}
 Options::Options(uint8_t const optLevel, bool const removeTTFhints) noexcept
     : pimpl(std::make_unique<Impl>(optLevel, removeTTFhints)) {}
 
 Options::~Options() = default;
+Options::Options(Options &&) noexcept = default;
+Options &
+Options::operator=(Options &&) noexcept = default;
+
+Options &
+Options::set_threadCount(size_t const threadCount) noexcept {
+    if (pimpl) { pimpl->_threadCount = threadCount; }
+    return *this;
+}
 
 
 // #####################################################################
@@ -134,87 +115,145 @@ public:
     Impl() : toKeep_unicodeCPs(hb_set_create()) {}
 
 private:
+    // One face of the waterfall. Lazy faces keep only their coverage resident, the face itself is (re)loaded from
+    // 'path' when it's needed and evicted again once the loaded lazy faces exceed 'faceMemoryBudget'.
+    struct registered_face {
+        hb_face_uptr          face;
+        hb_set_uptr           coverage; // Lazy faces only
+        std::filesystem::path path;
+        unsigned int          faceIndex    = 0;
+        size_t                byteSize     = 0;
+        uint64_t              lastUse      = 0;
+        uint64_t              expectedHash = 0; // Coverage index entries until their first load
+
+        bool
+        lazy() const noexcept {
+            return coverage != nullptr;
+        }
+    };
+
     void
     add_ff_toSubset(ByteSpan buf, unsigned int const faceIndex) {
         if (auto toInsert = make_ff(buf, faceIndex); toInsert.has_value()) {
-            ffs_toSubset.push_back(std::move(toInsert.value()));
+            ffs_toSubset.push_back(registered_face{.face = std::move(toInsert.value())});
         }
     }
     void
     add_ff_categoryBackup(ByteSpan buf, unsigned int const faceIndex) {
         if (auto toInsert = make_ff(buf, faceIndex); toInsert.has_value()) {
-            ffs_categoryBackup.push_back(std::move(toInsert.value()));
+            ffs_categoryBackup.push_back(registered_face{.face = std::move(toInsert.value())});
         }
     }
     void
     add_ff_lastResort(ByteSpan buf, unsigned int const faceIndex) {
         if (auto toInsert = make_ff(buf, faceIndex); toInsert.has_value()) {
-            ffs_lastResort.push_back(std::move(toInsert.value()));
+            ffs_lastResort.push_back(registered_face{.face = std::move(toInsert.value())});
         }
     }
 
     void
-    add_ff_toSubset(std::filesystem::path const &pth, unsigned int const faceIndex) {
-        if (auto exp_access = check_access(pth); exp_access.has_value()) {
-            if (exp_access->readable) {
-                std::basic_ifstream<char> file(pth, std::ios::binary);
-                if (! file) { goto RET; }
-
-                std::vector<char> const data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                if (data.empty()) { goto RET; }
-
-                if (auto toInsert = make_ff(
-                        std::span<const std::byte>(reinterpret_cast<const std::byte *>(data.data()), data.size()),
-                        faceIndex);
-                    toInsert.has_value()) {
-                    ffs_toSubset.push_back(std::move(toInsert.value()));
-                }
-            }
+    add_ff_toSubset(FontSource const &src, unsigned int const faceIndex) {
+        if (auto toInsert = make_ff(src, faceIndex); toInsert.has_value()) {
+            ffs_toSubset.push_back(registered_face{.face = std::move(toInsert.value())});
         }
-    RET:
-        return;
     }
     void
-    add_ff_categoryBackup(std::filesystem::path const &pth, unsigned int const faceIndex) {
-        if (auto exp_access = check_access(pth); exp_access.has_value()) {
-            if (exp_access->readable) {
-                std::basic_ifstream<char> file(pth, std::ios::binary);
-                if (! file) { goto RET; }
-
-                std::vector<char> const data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                if (data.empty()) { goto RET; }
-
-                if (auto toInsert = make_ff(
-                        std::span<const std::byte>(reinterpret_cast<const std::byte *>(data.data()), data.size()),
-                        faceIndex);
-                    toInsert.has_value()) {
-                    ffs_categoryBackup.push_back(std::move(toInsert.value()));
-                }
+    add_ff_categoryBackup(FontSource const &src, unsigned int const faceIndex) {
+        if (auto toInsert = make_ff(src, faceIndex); toInsert.has_value()) {
+            ffs_categoryBackup.push_back(registered_face{.face = std::move(toInsert.value())});
+        }
+    }
+    void
+    add_ff_lastResort(FontSource const &src, unsigned int const faceIndex) {
+        if (auto toInsert = make_ff(src, faceIndex); toInsert.has_value()) {
+            ffs_lastResort.push_back(registered_face{.face = std::move(toInsert.value())});
+        }
+    }
+
+    // The file is loaded once for its coverage and then let go of, unusable files are silently skipped
+    void
+    add_ff_lazy(std::vector<registered_face> &group, std::filesystem::path const &pth, unsigned int const faceIndex) {
+        auto exp_src = FontSource::from_file(pth);
+        if (not exp_src.has_value()) { return; }
+        auto exp_face = make_ff(exp_src.value(), faceIndex);
+        if (not exp_face.has_value()) { return; }
+
+        registered_face toInsert{.coverage  = hb_set_uptr(hb_set_create()),
+                                 .path      = pth,
+                                 .faceIndex = faceIndex,
+                                 .byteSize  = exp_src->bytes().size()};
+        hb_face_collect_unicodes(exp_face.value().get(), toInsert.coverage.get());
+        group.push_back(std::move(toInsert));
+    }
+
+    void
+    add_coverageIndex(CoverageIndex::Impl const &idx) {
+        for (auto const &entry : idx.entries) {
+            registered_face toInsert{.coverage     = hb_set_uptr(hb_set_create()),
+                                     .path         = entry.font.path,
+                                     .faceIndex    = entry.font.faceIndex,
+                                     .byteSize     = entry.fileSize,
+                                     .expectedHash = entry.contentHash};
+            for (uint32_t i = 0; i < entry.rangeCount; ++i) {
+                CPRange const rng = idx.range(entry, i);
+                hb_set_add_range(toInsert.coverage.get(), rng.first, rng.last);
+            }
+
+            switch (entry.font.group) {
+                case WaterfallGroup::toSubset:       ffs_toSubset.push_back(std::move(toInsert)); break;
+                case WaterfallGroup::categoryBackup: ffs_categoryBackup.push_back(std::move(toInsert)); break;
+                case WaterfallGroup::lastResort:     ffs_lastResort.push_back(std::move(toInsert)); break;
+            }
+        }
+    }
+
+    // Loads lazy faces that aren't resident (which may evict others)
+    std::expected<hb_face_t *, err_subset>
+    acquire(registered_face &rf, bool *const coverageChanged = nullptr) {
+        rf.lastUse = ++useClock;
+        if (rf.face) { return rf.face.get(); }
+
+        detail::_traceScope trace("subsetter.loadLazyFace");
+        auto                exp_src = FontSource::from_file(rf.path);
+        if (not exp_src.has_value()) { return std::unexpected(err_subset::lazyFace_loadFailure); }
+        auto exp_face = make_ff(exp_src.value(), rf.faceIndex);
+        if (not exp_face.has_value()) { return std::unexpected(err_subset::lazyFace_loadFailure); }
+        trace.set_bytesIn(exp_src->bytes().size());
+
+        rf.face          = std::move(exp_face.value());
+        rf.byteSize      = exp_src->bytes().size();
+        lazyResident    += rf.byteSize;
+
+        // Coverage index entries are verified on their first load, a font that changed since is rescanned
+        if (rf.expectedHash != 0) {
+            if (exp_src->fingerprint() != rf.expectedHash) {
+                hb_set_clear(rf.coverage.get());
+                hb_face_collect_unicodes(rf.face.get(), rf.coverage.get());
+                if (coverageChanged) { *coverageChanged = true; }
             }
+            rf.expectedHash = 0;
         }
-    RET:
-        return;
+        detail::metrics::add(detail::metrics::counter::lazyFaceLoads);
+        evict_lazyFaces(&rf);
+        return rf.face.get();
     }
+    // Least recently used first. 'keep' stays loaded even if it alone exceeds the budget.
     void
-    add_ff_lastResort(std::filesystem::path const &pth, unsigned int const faceIndex) {
-        if (auto exp_access = check_access(pth); exp_access.has_value()) {
-            if (exp_access->readable) {
-                std::basic_ifstream<char> file(pth, std::ios::binary);
-                if (! file) { goto RET; }
-
-                std::vector<char> const data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-                if (data.empty()) { goto RET; }
-
-                if (auto toInsert = make_ff(
-                        std::span<const std::byte>(reinterpret_cast<const std::byte *>(data.data()), data.size()),
-                        faceIndex);
-                    toInsert.has_value()) {
-                    ffs_lastResort.push_back(std::move(toInsert.value()));
+    evict_lazyFaces(const registered_face *const keep) {
+        if (faceMemoryBudget == 0) { return; }
+        while (lazyResident > faceMemoryBudget) {
+            registered_face *lru = nullptr;
+            for (auto *group : {&ffs_toSubset, &ffs_categoryBackup, &ffs_lastResort}) {
+                for (auto &rf : *group) {
+                    if (rf.lazy() && rf.face && &rf != keep && (lru == nullptr || rf.lastUse < lru->lastUse)) {
+                        lru = &rf;
+                    }
                 }
             }
+            if (lru == nullptr) { break; }
+            lru->face.reset();
+            lazyResident -= lru->byteSize;
         }
-    RET:
-        return;
     }
 
     std::expected<hb_face_uptr, err_subset>
@@ -229,17 +268,53 @@ private:
 
         return face;
     }
-
+    // The blob references FontSource's data directly and keeps it alive through its own copy of the shared handle
     std::expected<hb_face_uptr, err_subset>
-    make_subset(hb_face_t *ff) {
-        hb_set_uptr unicodes_toKeep_in_ff(hb_set_create());
-        hb_face_collect_unicodes(ff, unicodes_toKeep_in_ff.get());
+    make_ff(FontSource const &src, unsigned int const faceIndex) {
+        using keepAlive_t = std::shared_ptr<const FontSource::Impl>;
+
+        ByteSpan const data = src.pimpl->data;
+        hb_blob_uptr   blob(hb_blob_create_or_fail(
+            reinterpret_cast<const char *>(data.data()), data.size_bytes(), HB_MEMORY_MODE_READONLY,
+            new keepAlive_t(src.pimpl), [](void *ud) { delete static_cast<keepAlive_t *>(ud); }));
+        if (! blob) { return std::unexpected(err_subset::hb_blob_t_createFailure); }
+
+        hb_face_uptr face(hb_face_create_or_fail(blob.get(), faceIndex));
+        if (! face) { return std::unexpected(err_subset::hb_face_t_createFailure); }
+
+        return face;
+    }
+
+    // Codepoints to keep that 'rf' covers, lazy faces answer from their resident coverage (without loading)
+    hb_set_uptr
+    intersect_toKeep(registered_face const &rf) {
+        detail::_traceScope trace_collect("subsetter.collectUnicodes");
+        hb_set_uptr         res(hb_set_create());
+        if (rf.lazy()) { hb_set_set(res.get(), rf.coverage.get()); }
+        else { hb_face_collect_unicodes(rf.face.get(), res.get()); }
 
-        hb_set_intersect(unicodes_toKeep_in_ff.get(), toKeep_unicodeCPs.get());
+        hb_set_intersect(res.get(), toKeep_unicodeCPs.get());
+        return res;
+    }
+
+    std::expected<hb_face_uptr, err_subset>
+    make_subset(registered_face &rf) {
+        hb_set_uptr unicodes_toKeep_in_ff = intersect_toKeep(rf);
         if (hb_set_is_empty(unicodes_toKeep_in_ff.get())) {
             return std::unexpected(err_subset::make_subset_noIntersectingGlyphs);
         }
 
+        bool coverageChanged = false;
+        auto exp_ff          = acquire(rf, &coverageChanged);
+        if (not exp_ff.has_value()) { return std::unexpected(exp_ff.error()); }
+        hb_face_t *const ff = exp_ff.value();
+        if (coverageChanged) {
+            unicodes_toKeep_in_ff = intersect_toKeep(rf);
+            if (hb_set_is_empty(unicodes_toKeep_in_ff.get())) {
+                return std::unexpected(err_subset::make_subset_noIntersectingGlyphs);
+            }
+        }
+
         // Set the unicodes to keep in the subsetted font
         hb_subset_input_uptr si(hb_subset_input_create_or_fail());
         if (! si) { return std::unexpected(err_subset::subsetInput_failedToCreate); }
@@ -248,30 +323,224 @@ private:
         hb_set_set(si_inputUCCPs, unicodes_toKeep_in_ff.get());
 
         // Set subsetting flags
-        hb_subset_input_set_flags(si.get(), HB_SUBSET_FLAGS_DEFAULT);
+        hb_subset_input_set_flags(si.get(), subsetFlags);
+        if (tableProfile.has_value()) { apply_tableProfile(ff, si.get()); }
 
         // Execute subsetting
-        hb_face_uptr res(hb_subset_or_fail(ff, si.get()));
+        detail::_traceScope trace_subset("subsetter.hbSubset");
+        hb_face_uptr        res(hb_subset_or_fail(ff, si.get()));
         if (! res) { return std::unexpected(err_subset::hb_subset_executeFailure); }
+        if (trace_subset.active()) {
+            trace_subset.set_bytesIn(hb_face_byteSize(ff));
+            trace_subset.set_bytesOut(hb_face_byteSize(res.get()));
+            trace_subset.set_glyphCount(hb_face_get_glyph_count(res.get()));
+        }
+        trace_subset.end();
 
         // Only keep the remaining unicodeCPs by 'filtering' the ones we use from
         // 'ff'
         hb_set_symmetric_difference(toKeep_unicodeCPs.get(), unicodes_toKeep_in_ff.get());
         return res;
     }
-    std::expected<bool, err_subset>
-    should_include_category(hb_face_t *ff) {
-        hb_set_uptr unicodes_toKeep_in_ff(hb_set_create());
-        hb_face_collect_unicodes(ff, unicodes_toKeep_in_ff.get());
-
-        hb_set_intersect(unicodes_toKeep_in_ff.get(), toKeep_unicodeCPs.get());
+    // Adds the tables of 'ff' the profile drops to harfbuzz's own drop list, name IDs replace harfbuzz's default set
+    void
+    apply_tableProfile(hb_face_t *const ff, hb_subset_input_t *const si) const {
+        unsigned int          tableCount = hb_face_get_table_tags(ff, 0, nullptr, nullptr);
+        std::vector<hb_tag_t> present(tableCount);
+        hb_face_get_table_tags(ff, 0, &tableCount, present.data());
+        present.resize(tableCount);
+
+        hb_set_t *dropTags = hb_subset_input_set(si, HB_SUBSET_SETS_DROP_TABLE_TAG);
+        for (uint32_t const tag : detail::table_profile::dropped(tableProfile.value(), present)) {
+            hb_set_add(dropTags, tag);
+        }
+        // Instructions left without their 'fpgm' or 'cvt ' break the rasterizer, harfbuzz strips them with the rest
+        if (detail::table_profile::drops_hinting(tableProfile.value())) {
+            hb_subset_input_set_flags(si, hb_subset_input_get_flags(si) | HB_SUBSET_FLAGS_NO_HINTING);
+        }
+        if (not tableProfile->nameIDs.empty()) {
+            hb_set_t *nameIDs = hb_subset_input_set(si, HB_SUBSET_SETS_NAME_ID);
+            hb_set_clear(nameIDs);
+            for (uint16_t const id : tableProfile->nameIDs) { hb_set_add(nameIDs, id); }
+        }
+    }
 
-        bool res = not hb_set_is_empty(unicodes_toKeep_in_ff.get());
+    std::expected<bool, err_subset>
+    should_include_category(registered_face &rf) {
+        hb_set_uptr unicodes_toKeep_in_ff = intersect_toKeep(rf);
+        if (hb_set_is_empty(unicodes_toKeep_in_ff.get())) { return false; }
+
+        // Included faces get loaded (which may find out that the coverage was stale)
+        bool coverageChanged = false;
+        auto exp_ff          = acquire(rf, &coverageChanged);
+        if (not exp_ff.has_value()) { return std::unexpected(exp_ff.error()); }
+        if (coverageChanged) {
+            unicodes_toKeep_in_ff = intersect_toKeep(rf);
+            if (hb_set_is_empty(unicodes_toKeep_in_ff.get())) { return false; }
+        }
 
         // Only keep the remaining unicodeCPs by 'filtering' the ones we use from
         // 'ff'
         hb_set_symmetric_difference(toKeep_unicodeCPs.get(), unicodes_toKeep_in_ff.get());
-        return res;
+        return true;
+    }
+
+    // Every run of set bits becomes one range, runs may continue across word boundaries
+    void
+    add_CPBitmap(std::span<const uint64_t> const bitmap, uint32_t const firstCP) {
+        hb_set_t *const         set = toKeep_unicodeCPs.get();
+        std::optional<uint32_t> runStart;
+        for (size_t w = 0; w < bitmap.size(); ++w) {
+            uint64_t       word = bitmap[w];
+            uint32_t const base = firstCP + static_cast<uint32_t>(w * 64);
+
+            if (runStart.has_value()) {
+                int const ones = std::countr_one(word);
+                if (ones == 64) { continue; }
+                hb_set_add_range(set, runStart.value(), base + ones - 1);
+                runStart.reset();
+                word &= ~((uint64_t{1} << ones) - 1);
+            }
+            while (word != 0) {
+                int const from = std::countr_zero(word);
+                int const ones = std::countr_one(word >> from);
+                if (from + ones == 64) {
+                    runStart = base + from;
+                    break;
+                }
+                hb_set_add_range(set, base + from, base + from + ones - 1);
+                word &= ~(((uint64_t{1} << ones) - 1) << from);
+            }
+        }
+        if (runStart.has_value()) {
+            hb_set_add_range(set, runStart.value(), firstCP + static_cast<uint32_t>(bitmap.size() * 64) - 1);
+        }
+    }
+
+    // Text input. Decoded codepoints are deduplicated in 'text_cpBitmap' and only go into 'toKeep_unicodeCPs' once
+    // the text is finished. Invalid text is dropped as a whole and puts the Subsetter in error.
+    void
+    feed_text(std::span<const uint8_t> const utf8Chunk) {
+        if (inError.has_value() || utf8Chunk.empty()) { return; }
+        detail::_traceScope trace("subsetter.decodeText");
+        trace.set_bytesIn(utf8Chunk.size());
+
+        if (text_cpBitmap.empty()) { text_cpBitmap.resize(detail::utf::bitmapWords); }
+        if (not text_utf8.feed(utf8Chunk.data(), utf8Chunk.size(), text_cpBitmap.data())) {
+            drop_text(err_subset::text_invalidUTF8);
+        }
+    }
+    void
+    feed_text(std::span<const char16_t> const utf16Chunk) {
+        if (inError.has_value() || utf16Chunk.empty()) { return; }
+        detail::_traceScope trace("subsetter.decodeText");
+        trace.set_bytesIn(utf16Chunk.size_bytes());
+
+        if (text_cpBitmap.empty()) { text_cpBitmap.resize(detail::utf::bitmapWords); }
+        if (not text_utf16.feed(utf16Chunk.data(), utf16Chunk.size(), text_cpBitmap.data())) {
+            drop_text(err_subset::text_invalidUTF16);
+        }
+    }
+    void
+    finish_text() {
+        bool const utf8_ok  = text_utf8.finish();
+        bool const utf16_ok = text_utf16.finish();
+        if (inError.has_value()) { return; }
+        if (not utf8_ok) { return drop_text(err_subset::text_invalidUTF8); }
+        if (not utf16_ok) { return drop_text(err_subset::text_invalidUTF16); }
+
+        if (text_cpBitmap.empty()) { return; }
+        add_CPBitmap(text_cpBitmap, 0);
+        text_cpBitmap = std::vector<uint64_t>();
+    }
+    void
+    drop_text(err_subset const e) {
+        text_utf8.reset();
+        text_utf16.reset();
+        text_cpBitmap = std::vector<uint64_t>();
+        if (not inError.has_value()) { inError = e; }
+    }
+
+    // Goes through the waterfall, the codepoints that weren't found anywhere remain in 'toKeep_unicodeCPs'.
+    // 'faceSlots' (optional) receives the position of each result's face in the waterfall (all 3 groups in order).
+    std::expected<std::vector<Bytes>, err_subset>
+    execute_waterfall(std::vector<size_t> *faceSlots = nullptr) {
+        namespace metrics = detail::metrics;
+
+        // Text that wasn't explicitly finished counts as finished now
+        finish_text();
+        if (inError.has_value()) { return std::unexpected(inError.value()); }
+
+        detail::_traceScope       trace("subsetter.execute");
+        metrics::_latencyScope    latency(metrics::histogram::subsetLatency_us);
+        std::vector<hb_blob_uptr> res;
+
+        auto const failed = [](err_subset const e) {
+            metrics::add(metrics::counter::subsetsFailed);
+            return std::unexpected(e);
+        };
+        auto const allFound = [&]() { return hb_set_is_empty(toKeep_unicodeCPs.get()); };
+
+        size_t     slot   = 0;
+        auto const pushed = [&](hb_face_t *face) {
+            res.push_back(hb_blob_uptr(hb_face_reference_blob(face)));
+            if (faceSlots) { faceSlots->push_back(slot); }
+        };
+
+        for (auto &ff_to : ffs_toSubset) {
+            if (allFound()) { break; }
+            if (auto const st = execCheck.check()) { return failed(detail::to_err<err_subset>(st.value())); }
+
+            auto exp_ff = make_subset(ff_to);
+            if (not exp_ff.has_value()) {
+                if (exp_ff.error() != err_subset::make_subset_noIntersectingGlyphs) { return failed(exp_ff.error()); }
+            }
+            else { pushed(exp_ff.value().get()); }
+            ++slot;
+        }
+
+        slot = ffs_toSubset.size();
+        for (auto &ff_to : ffs_categoryBackup) {
+            if (allFound()) { break; }
+            if (auto const st = execCheck.check()) { return failed(detail::to_err<err_subset>(st.value())); }
+
+            auto exp_ff = should_include_category(ff_to);
+            if (not exp_ff.has_value()) {
+                if (exp_ff.error() != err_subset::make_subset_noIntersectingGlyphs) { return failed(exp_ff.error()); }
+            }
+            else if (exp_ff.value()) { pushed(ff_to.face.get()); }
+            ++slot;
+        }
+
+        slot = ffs_toSubset.size() + ffs_categoryBackup.size();
+        for (auto &ff_to : ffs_lastResort) {
+            if (allFound()) { break; }
+            if (auto const st = execCheck.check()) { return failed(detail::to_err<err_subset>(st.value())); }
+
+            auto exp_ff = make_subset(ff_to);
+            if (not exp_ff.has_value()) {
+                if (exp_ff.error() != err_subset::make_subset_noIntersectingGlyphs) { return failed(exp_ff.error()); }
+            }
+            else { pushed(exp_ff.value().get()); }
+            ++slot;
+        }
+
+        uint64_t bytesOut = 0;
+        for (auto const &blob : res) { bytesOut += hb_blob_get_length(blob.get()); }
+        trace.set_bytesOut(bytesOut);
+
+        metrics::add(metrics::counter::subsetsExecuted);
+        metrics::add(metrics::counter::facesTouched, res.size());
+        metrics::add(metrics::counter::subsetBytesOut, bytesOut);
+        metrics::observe(metrics::histogram::facesPerSubset, res.size());
+
+        return std::vector<Bytes>(std::from_range, res | std::views::transform([](auto const &item) {
+                                                       unsigned int length;
+                                                       const char  *data = hb_blob_get_data(item.get(), &length);
+                                                       return Bytes(std::from_range,
+                                                                    std::span(reinterpret_cast<const std::byte *>(data),
+                                                                              length));
+                                                   }));
     }
 
     hb_set_uptr toKeep_unicodeCPs;
@@ -283,9 +552,21 @@ private:
     // still have some unicodeCPs to keep (because they are NOT in either of the
     // above) ... font faces with large unicode CP coverage are good here (ie.
     // Iosevka)
-    std::vector<hb_face_uptr> ffs_toSubset;
-    std::vector<hb_face_uptr> ffs_categoryBackup;
-    std::vector<hb_face_uptr> ffs_lastResort;
+    std::vector<registered_face> ffs_toSubset;
+    std::vector<registered_face> ffs_categoryBackup;
+    std::vector<registered_face> ffs_lastResort;
+
+    size_t   faceMemoryBudget = 0; // Bytes of loaded lazy faces, 0 = unlimited
+    size_t   lazyResident     = 0;
+    uint64_t useClock         = 0;
+
+    hb_subset_flags_t           subsetFlags = HB_SUBSET_FLAGS_DEFAULT;
+    std::optional<TableProfile> tableProfile;
+    detail::_execCheck          execCheck; // Set for the duration of an async execution
+
+    std::vector<uint64_t>      text_cpBitmap;
+    detail::utf::utf8_decoder  text_utf8;
+    detail::utf::utf16_decoder text_utf16;
 
     std::optional<err_subset> inError = std::nullopt;
 };
@@ -313,19 +594,69 @@ Subsetter::add_ff_lastResort(ByteSpan buf, unsigned int const faceIndex) {
     return *this;
 }
 
+// Files are memory mapped through FontSource, unreadable files are silently skipped (as before)
 Subsetter &
 Subsetter::add_ff_toSubset(std::filesystem::path const &pth, unsigned int const faceIndex) {
-    pimpl->add_ff_toSubset(pth, faceIndex);
+    if (auto exp_src = FontSource::from_file(pth); exp_src.has_value()) {
+        pimpl->add_ff_toSubset(*exp_src, faceIndex);
+    }
     return *this;
 }
 Subsetter &
 Subsetter::add_ff_categoryBackup(std::filesystem::path const &pth, unsigned int const faceIndex) {
-    pimpl->add_ff_categoryBackup(pth, faceIndex);
+    if (auto exp_src = FontSource::from_file(pth); exp_src.has_value()) {
+        pimpl->add_ff_categoryBackup(*exp_src, faceIndex);
+    }
     return *this;
 }
 Subsetter &
 Subsetter::add_ff_lastResort(std::filesystem::path const &pth, unsigned int const faceIndex) {
-    pimpl->add_ff_lastResort(pth, faceIndex);
+    if (auto exp_src = FontSource::from_file(pth); exp_src.has_value()) {
+        pimpl->add_ff_lastResort(*exp_src, faceIndex);
+    }
+    return *this;
+}
+
+Subsetter &
+Subsetter::add_ff_toSubset_lazy(std::filesystem::path const &pth, unsigned int const faceIndex) {
+    pimpl->add_ff_lazy(pimpl->ffs_toSubset, pth, faceIndex);
+    return *this;
+}
+Subsetter &
+Subsetter::add_ff_categoryBackup_lazy(std::filesystem::path const &pth, unsigned int const faceIndex) {
+    pimpl->add_ff_lazy(pimpl->ffs_categoryBackup, pth, faceIndex);
+    return *this;
+}
+Subsetter &
+Subsetter::add_ff_lastResort_lazy(std::filesystem::path const &pth, unsigned int const faceIndex) {
+    pimpl->add_ff_lazy(pimpl->ffs_lastResort, pth, faceIndex);
+    return *this;
+}
+Subsetter &
+Subsetter::add_coverageIndex(CoverageIndex const &idx) {
+    pimpl->add_coverageIndex(*idx.pimpl);
+    return *this;
+}
+Subsetter &
+Subsetter::set_faceMemoryBudget(size_t const bytes) {
+    pimpl->faceMemoryBudget = bytes;
+    pimpl->evict_lazyFaces(nullptr);
+    return *this;
+}
+
+Subsetter &
+Subsetter::add_ff_toSubset(FontSource const &src, unsigned int const faceIndex) {
+    pimpl->add_ff_toSubset(src, faceIndex);
+    return *this;
+}
+Subsetter &
+Subsetter::add_ff_categoryBackup(FontSource const &src, unsigned int const faceIndex) {
+    pimpl->add_ff_categoryBackup(src, faceIndex);
+    return *this;
+}
+Subsetter &
+Subsetter::add_ff_lastResort(FontSource const &src, unsigned int const faceIndex) {
+    pimpl->add_ff_lastResort(src, faceIndex);
     return *this;
 }
 
@@ -357,77 +688,259 @@ Subsetter::add_toKeep_CP(hb_codepoint_t const cp) {
 
 Subsetter &
 Subsetter::add_toKeep_CPs(std::span<const hb_codepoint_t> const cps) {
+    // Sorted input (the common case) goes in as one bulk insertion
+    if (std::ranges::is_sorted(cps)) { return add_toKeep_CPsSorted(cps); }
     for (auto const &cp : cps) { hb_set_add(pimpl->toKeep_unicodeCPs.get(), cp); }
     return *this;
 }
+Subsetter &
+Subsetter::add_toKeep_CPsSorted(std::span<const hb_codepoint_t> const sortedCPs) {
+    hb_set_add_sorted_array(pimpl->toKeep_unicodeCPs.get(), sortedCPs.data(), sortedCPs.size());
+    return *this;
+}
+
+Subsetter &
+Subsetter::add_toKeep_CPRange(uint32_t const first, uint32_t const last) {
+    if (first <= last) { hb_set_add_range(pimpl->toKeep_unicodeCPs.get(), first, last); }
+    return *this;
+}
+Subsetter &
+Subsetter::add_toKeep_CPRanges(std::span<const CPRange> const ranges) {
+    for (auto const &rng : ranges) { add_toKeep_CPRange(rng.first, rng.last); }
+    return *this;
+}
+
+Subsetter &
+Subsetter::add_toKeep_CPBitmap(std::span<const uint64_t> const bitmap, uint32_t const firstCP) {
+    pimpl->add_CPBitmap(bitmap, firstCP);
+    return *this;
+}
+
+// Text
+Subsetter &
+Subsetter::add_toKeep_text(std::string_view const utf8) {
+    return add_toKeep_textChunk(utf8).finish_text();
+}
+Subsetter &
+Subsetter::add_toKeep_text(std::u8string_view const utf8) {
+    return add_toKeep_textChunk(utf8).finish_text();
+}
+Subsetter &
+Subsetter::add_toKeep_text(std::u16string_view const utf16) {
+    return add_toKeep_textChunk(utf16).finish_text();
+}
+
+Subsetter &
+Subsetter::add_toKeep_textChunk(std::string_view const utf8Chunk) {
+    pimpl->feed_text(std::span(reinterpret_cast<const uint8_t *>(utf8Chunk.data()), utf8Chunk.size()));
+    return *this;
+}
+Subsetter &
+Subsetter::add_toKeep_textChunk(std::u8string_view const utf8Chunk) {
+    pimpl->feed_text(std::span(reinterpret_cast<const uint8_t *>(utf8Chunk.data()), utf8Chunk.size()));
+    return *this;
+}
+Subsetter &
+Subsetter::add_toKeep_textChunk(std::u16string_view const utf16Chunk) {
+    pimpl->feed_text(std::span(utf16Chunk.data(), utf16Chunk.size()));
+    return *this;
+}
+Subsetter &
+Subsetter::finish_text() {
+    pimpl->finish_text();
+    return *this;
+}
+
+Subsetter &
+Subsetter::add_toKeep_textFile(std::filesystem::path const &pth) {
+    detail::_allocScope allocs("Subsetter::add_toKeep_textFile");
+
+    std::ifstream ifs(pth, std::ios::binary);
+    if (not ifs) {
+        pimpl->drop_text(err_subset::text_fileReadFailure);
+        return *this;
+    }
+
+    // Read in fixed size chunks, the file is never in memory as a whole
+    std::vector<char> buf(64 * 1024);
+    while (ifs) {
+        ifs.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+        add_toKeep_textChunk(std::string_view(buf.data(), static_cast<size_t>(ifs.gcount())));
+    }
+    if (ifs.bad()) {
+        pimpl->drop_text(err_subset::text_fileReadFailure);
+        return *this;
+    }
+    return finish_text();
+}
 
 // Execution
 std::expected<std::vector<Bytes>, err_subset>
 Subsetter::execute() {
-    if (auto res = execute_bestEffort(); res.has_value()) {
-        if (res.value().second.empty()) { return std::move(res.value().first); }
-        else { return std::unexpected(err_subset::execute_someRequestedGlyphsAreMissing); }
+    detail::_allocScope allocs("Subsetter::execute");
+
+    auto exp_res = pimpl->execute_waterfall();
+    if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+    if (not hb_set_is_empty(pimpl->toKeep_unicodeCPs.get())) {
+        return std::unexpected(err_subset::execute_someRequestedGlyphsAreMissing);
     }
-    else { return std::unexpected(res.error()); }
+    return std::move(exp_res.value());
 }
 
 std::expected<std::pair<std::vector<Bytes>, std::vector<uint32_t>>, err_subset>
 Subsetter::execute_bestEffort() {
-    std::vector<hb_blob_uptr> res;
+    detail::_allocScope allocs("Subsetter::execute_bestEffort");
+
+    auto exp_res = pimpl->execute_waterfall();
+    if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
 
-    for (auto &ff_to : pimpl->ffs_toSubset) {
-        if (hb_set_is_empty(pimpl->toKeep_unicodeCPs.get())) { goto RET; }
+    std::vector<uint32_t> resVec;
+    resVec.reserve(hb_set_get_population(pimpl->toKeep_unicodeCPs.get()));
 
-        auto exp_ff = pimpl->make_subset(ff_to.get());
-        if (not exp_ff.has_value()) {
-            if (exp_ff.error() == err_subset::make_subset_noIntersectingGlyphs) { continue; }
-            else { return std::unexpected(exp_ff.error()); }
-        }
-        else { res.push_back(hb_blob_uptr(hb_face_reference_blob(exp_ff.value().get()))); }
-    }
+    hb_codepoint_t curCP = HB_SET_VALUE_INVALID;
+    while (hb_set_next(pimpl->toKeep_unicodeCPs.get(), &curCP)) { resVec.push_back(curCP); }
 
-    for (auto &ff_to : pimpl->ffs_categoryBackup) {
-        if (hb_set_is_empty(pimpl->toKeep_unicodeCPs.get())) { goto RET; }
+    return std::make_pair(std::move(exp_res.value()), std::move(resVec));
+}
 
-        auto exp_ff = pimpl->should_include_category(ff_to.get());
-        if (not exp_ff.has_value()) {
-            if (exp_ff.error() == err_subset::make_subset_noIntersectingGlyphs) { continue; }
-            else { return std::unexpected(exp_ff.error()); }
-        }
-        else { res.push_back(hb_blob_uptr(hb_face_reference_blob(ff_to.get()))); }
+std::expected<std::pair<std::vector<Bytes>, std::vector<CPRange>>, err_subset>
+Subsetter::execute_bestEffortRanges() {
+    detail::_allocScope allocs("Subsetter::execute_bestEffortRanges");
+
+    auto exp_res = pimpl->execute_waterfall();
+    if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+
+    std::vector<CPRange> resVec;
+    hb_codepoint_t       first = HB_SET_VALUE_INVALID, last = HB_SET_VALUE_INVALID;
+    while (hb_set_next_range(pimpl->toKeep_unicodeCPs.get(), &first, &last)) { resVec.push_back({first, last}); }
+
+    return std::make_pair(std::move(exp_res.value()), std::move(resVec));
+}
+
+std::expected<Bytes, err_subset>
+Subsetter::execute_merged(ModifierRecipe const &recipe) {
+    detail::_allocScope allocs("Subsetter::execute_merged");
+
+    std::vector<size_t> slots;
+    auto                exp_subsets = pimpl->execute_waterfall(&slots);
+    if (not exp_subsets.has_value()) { return std::unexpected(exp_subsets.error()); }
+    if (not hb_set_is_empty(pimpl->toKeep_unicodeCPs.get())) {
+        return std::unexpected(err_subset::execute_someRequestedGlyphsAreMissing);
     }
+    if (exp_subsets->empty()) { return std::unexpected(err_subset::merge_failure); }
 
-    for (auto &ff_to : pimpl->ffs_lastResort) {
-        if (hb_set_is_empty(pimpl->toKeep_unicodeCPs.get())) { goto RET; }
+    auto const toErr = [](err_modifier const e) {
+        if (e == err_modifier::cancelled) { return err_subset::cancelled; }
+        if (e == err_modifier::deadlineExceeded) { return err_subset::deadlineExceeded; }
+        return err_subset::merge_failure;
+    };
 
-        auto exp_ff = pimpl->make_subset(ff_to.get());
-        if (not exp_ff.has_value()) {
-            if (exp_ff.error() == err_subset::make_subset_noIntersectingGlyphs) { continue; }
-            else { return std::unexpected(exp_ff.error()); }
-        }
-        else { res.push_back(hb_blob_uptr(hb_face_reference_blob(exp_ff.value().get()))); }
+    // Subsets are single fonts, category backup faces are passed on whole (possibly a collection)
+    auto const parse = [&](size_t const i) {
+        auto const  &backups   = pimpl->ffs_categoryBackup;
+        size_t const firstSlot = pimpl->ffs_toSubset.size();
+        bool const   isBackup  = slots[i] >= firstSlot && slots[i] - firstSlot < backups.size();
+        return Modifier::create(ByteSpan((*exp_subsets)[i]), isBackup ? backups[slots[i] - firstSlot].faceIndex : 0);
+    };
+
+    // The waterfall order is the priority, each face only adds the codepoints none before it had
+    auto exp_merged = parse(0);
+    if (not exp_merged.has_value()) { return std::unexpected(toErr(exp_merged.error())); }
+    Modifier &merged = exp_merged.value();
+    for (size_t i = 1; i < exp_subsets->size(); ++i) {
+        auto exp_face = parse(i);
+        if (not exp_face.has_value()) { return std::unexpected(toErr(exp_face.error())); }
+        auto exp_res = merged.merge_glyphsFrom(exp_face.value());
+        if (not exp_res.has_value()) { return std::unexpected(toErr(exp_res.error())); }
+    }
+    if (auto exp_res = merged.apply_recipe(recipe); not exp_res.has_value()) {
+        return std::unexpected(toErr(exp_res.error()));
     }
 
-RET:
-    std::vector<uint32_t> resVec;
+    auto exp_font = merged.exportResult(recipe.exportOpts);
+    if (not exp_font.has_value()) { return std::unexpected(toErr(exp_font.error())); }
+    return std::move(exp_font.value());
+}
+
+Subsetter &
+Subsetter::set_tableProfile(TableProfile profile) {
+    pimpl->tableProfile = std::move(profile);
+    return *this;
+}
 
-    {
-        auto curCP = std::make_unique<hb_codepoint_t>(HB_SET_VALUE_INVALID);
+Subsetter &
+Subsetter::set_retainGlyphIDs(bool const retain) {
+    pimpl->subsetFlags = static_cast<hb_subset_flags_t>(retain ? pimpl->subsetFlags | HB_SUBSET_FLAGS_RETAIN_GIDS
+                                                               : pimpl->subsetFlags & ~HB_SUBSET_FLAGS_RETAIN_GIDS);
+    return *this;
+}
+
+std::expected<std::vector<SubsetDelta>, err_subset>
+Subsetter::execute_delta(std::span<const CPRange> const clientHas) {
+    namespace metrics = detail::metrics;
 
-        auto rf = pimpl->toKeep_unicodeCPs.get();
+    detail::_allocScope allocs("Subsetter::execute_delta");
+    auto               &impl = *pimpl;
 
-        while (hb_set_next(pimpl->toKeep_unicodeCPs.get(), curCP.get())) { resVec.push_back(*curCP); }
+    hb_set_uptr held(hb_set_create());
+    for (auto const &rng : clientHas) {
+        if (rng.first <= rng.last) { hb_set_add_range(held.get(), rng.first, rng.last); }
     }
+    impl.finish_text();
+    hb_set_uptr extended(hb_set_copy(impl.toKeep_unicodeCPs.get()));
+    hb_set_union(extended.get(), held.get());
+
+    // Both outputs keep the original glyph IDs, that is what makes the extended one a drop-in superset
+    auto const flagsBackup = impl.subsetFlags;
+    impl.subsetFlags       = static_cast<hb_subset_flags_t>(flagsBackup | HB_SUBSET_FLAGS_RETAIN_GIDS);
+
+    // Reproduce what the client holds (subsetting is deterministic), then subset for everything
+    std::vector<size_t> prevSlots;
+    hb_set_set(impl.toKeep_unicodeCPs.get(), held.get());
+    auto exp_prev = impl.execute_waterfall(&prevSlots);
+
+    std::vector<size_t> nextSlots;
+    hb_set_set(impl.toKeep_unicodeCPs.get(), extended.get());
+    auto exp_next = exp_prev.has_value() ? impl.execute_waterfall(&nextSlots) : std::move(exp_prev);
+
+    impl.subsetFlags = flagsBackup;
+    if (not exp_next.has_value()) { return std::unexpected(exp_next.error()); }
+
+    // A codepoint always goes to the first face that has it, so every face of the previous output is also present
+    // in the extended one
+    detail::_traceScope trace("subsetter.encodePatches");
+    std::vector<SubsetDelta> res;
+    res.reserve(exp_next->size());
+    for (size_t i = 0; i < exp_next->size(); ++i) {
+        SubsetDelta &dlt = res.emplace_back();
+        dlt.faceSlot     = nextSlots[i];
+        dlt.font         = std::move(exp_next.value()[i]);
+
+        auto const prevIt = std::ranges::find(prevSlots, dlt.faceSlot);
+        ByteSpan   prev;
+        if (prevIt != prevSlots.end()) { prev = exp_prev.value()[prevIt - prevSlots.begin()]; }
+        dlt.isNewFace     = prevIt == prevSlots.end();
+        dlt.previousBytes = prev.size();
+        dlt.patch         = detail::patch::encode(prev, dlt.font);
+
+        metrics::add(metrics::counter::deltaBytesSaved, dlt.bytesSaved());
+    }
+    if (trace.active()) {
+        uint64_t bytesOut = 0;
+        for (auto const &dlt : res) { bytesOut += dlt.patch.size(); }
+        trace.set_bytesOut(bytesOut);
+    }
+    return res;
+}
 
-    return std::make_pair(
-        std::vector<Bytes>(std::from_range, res | std::views::transform([](auto const &item) {
-                                                unsigned int length;
-                                                const char  *data = hb_blob_get_data(item.get(), &length);
-                                                return Bytes(
-                                                    std::from_range,
-                                                    std::span(reinterpret_cast<const std::byte *>(data), length));
-                                            })),
-        std::move(resVec));
+std::future<std::expected<std::vector<Bytes>, err_subset>>
+Subsetter::execute_async(Subsetter subs, ExecControl ctl, Executor &exec) {
+    return detail::submit_async(exec, [subs = std::move(subs), ctl = std::move(ctl)]() mutable {
+        subs.pimpl->execCheck = detail::_execCheck(ctl);
+        auto res              = subs.execute();
+        subs.pimpl->execCheck = detail::_execCheck();
+        return res;
+    });
 }
 
 bool
@@ -450,57 +963,231 @@ class Modifier::Impl {
 public:
     Impl() = delete;
     // Impl(Bytes const &ttf) {}
-    Impl(ByteSpan raw_ttfFont, Options const &opts, uint32_t ttcindex) {
-        otfccxx::fmem_file memfile{};
+    Impl(ByteSpan raw_ttfFont, Options const &opts, uint32_t ttcindex, detail::_execCheck const &chk = {}) {
+        detail::_allocScope allocs("Modifier::Modifier");
+        otfccxx::fmem_file  memfile{};
+        if (! opts.pimpl) {
+            _failed = err_modifier::unexpectedNullptr;
+            return;
+        }
 
-        otfcc_SplineFontContainer *sfnt = otfcc_readSFNT(memfile.attach(raw_ttfFont));
-        if (! sfnt || sfnt->count == 0) { std::exit(1); }
-        if (ttcindex >= sfnt->count) { std::exit(1); }
+        _stopped = chk.check();
+        if (_stopped.has_value()) { return; }
 
-        // Build font
-        otfcc_IFontBuilder *reader = otfcc_newOTFReader();
-        _font                      = otfcc_Font_uptr(reader->read(sfnt, ttcindex, opts.pimpl.get()->_opts.get()));
-        if (! _font) { std::exit(1); }
+        detail::metrics::_latencyScope latency(detail::metrics::histogram::parseLatency_us);
+        detail::metrics::add(detail::metrics::counter::parseBytesIn, raw_ttfFont.size());
 
-        // Free no longer needed stuff
-        reader->free(reader);
-        if (sfnt) { otfcc_deleteSFNT(sfnt); }
+        detail::_traceScope trace_read("modifier.readSFNT");
+        trace_read.set_bytesIn(raw_ttfFont.size());
+        otfcc_SplineFontContainer *sfnt = otfcc_readSFNT(memfile.attach(raw_ttfFont));
+        trace_read.end();
+        if (not check_sfnt(sfnt, ttcindex)) { return; }
 
-        // Consolidate
-        otfcc_iFont.consolidate(_font.get(), opts.pimpl.get()->_opts.get());
+        _stopped = chk.check();
+        if (_stopped.has_value()) {
+            otfcc_deleteSFNT(sfnt);
+            return;
+        }
+        build_andConsolidate(sfnt, opts, ttcindex, chk);
     }
     Impl(std::filesystem::path const &pth, Options const &opts, uint32_t ttcindex) {
+        detail::_allocScope allocs("Modifier::Modifier");
+        if (! opts.pimpl) {
+            _failed = err_modifier::unexpectedNullptr;
+            return;
+        }
 
-        // TODO: Needs to rounded off as opposed to hard exit
         FILE *file = std::fopen(pth.string().c_str(), "rb"); // "rb" = read binary
         if (! file) {
-            std::perror("Failed to open file");
-            std::exit(1);
+            _failed = err_modifier::cannotOpenFile;
+            return;
         }
 
+        detail::metrics::_latencyScope latency(detail::metrics::histogram::parseLatency_us);
+
+        std::error_code ec;
+        uint64_t const  fileSize = std::filesystem::file_size(pth, ec);
+        detail::metrics::add(detail::metrics::counter::parseBytesIn, ec ? 0 : fileSize);
+
+        detail::_traceScope trace_read("modifier.readSFNT");
+        trace_read.set_bytesIn(ec ? 0 : fileSize);
         otfcc_SplineFontContainer *sfnt = otfcc_readSFNT(file);
+        std::fclose(file);
+        trace_read.end();
+        if (not check_sfnt(sfnt, ttcindex)) { return; }
 
-        if (! sfnt || sfnt->count == 0) { std::exit(1); }
-        if (ttcindex >= sfnt->count) { std::exit(1); }
+        build_andConsolidate(sfnt, opts, ttcindex);
+    }
 
-        // Build font
-        otfcc_IFontBuilder *reader = otfcc_newOTFReader();
-        _font                      = otfcc_Font_uptr(reader->read(sfnt, ttcindex, opts.pimpl.get()->_opts.get()));
-        if (! _font) { std::exit(1); }
+    // The snapshot's font was consolidated before it was written, so that is skipped here (exportResult() does it
+    // anyway). Unreadable data leaves the font missing, that includes data otfcc's reader rejects past the checksum.
+    struct from_snapshot_t {};
+    Impl(ByteSpan sfntData, uint64_t const sourceFingerprint, from_snapshot_t) : _sourceFingerprint(sourceFingerprint) {
+        detail::_allocScope allocs("Modifier::from_snapshot");
+        otfccxx::fmem_file  memfile{};
+
+        detail::metrics::_latencyScope latency(detail::metrics::histogram::parseLatency_us);
+        detail::metrics::add(detail::metrics::counter::parseBytesIn, sfntData.size());
+
+        detail::_traceScope trace_read("modifier.readSFNT");
+        trace_read.set_bytesIn(sfntData.size());
+        otfcc_SplineFontContainer *sfnt = otfcc_readSFNT(memfile.attach(sfntData));
+        trace_read.end();
+        if (! sfnt || sfnt->count == 0) {
+            if (sfnt) { otfcc_deleteSFNT(sfnt); }
+            return;
+        }
+        build_andConsolidate(sfnt, Options(1, false), 0, {}, false);
+    }
 
-        // Free no longer needed stuff
-        reader->free(reader);
-        if (sfnt) { otfcc_deleteSFNT(sfnt); }
+    // Deep copy of an already built font, 'other' is left untouched. The copy has no glyph order, consolidation at
+    // export rebuilds it from the glyph names. Failure leaves the font missing.
+    struct clone_t {};
+    Impl(Impl const &other, clone_t)
+        : _ctl(other._ctl), _progress(other._progress), _glyphBatch(other._glyphBatch),
+          _sourceFingerprint(other._sourceFingerprint) {
+        detail::_allocScope allocs("Modifier::clone");
+        detail::_traceScope trace_copy("modifier.copyFont");
+        if (other._font->glyf) { trace_copy.set_glyphCount(other._font->glyf->length); }
+        _font = detail::copy_font(*other._font);
+        if (_font) { detail::metrics::add(detail::metrics::counter::modifiersCloned); }
+    }
 
-        // Consolidate
+    // Font built by the caller (eg. from JSON), consolidated with 'opts'
+    struct from_font_t {};
+    Impl(otfcc_Font_uptr font, uint64_t const sourceFingerprint, Options const &opts, from_font_t)
+        : _font(std::move(font)), _sourceFingerprint(sourceFingerprint) {
+        if (! _font) { return; }
+        detail::_traceScope trace_consolidate("modifier.consolidate");
         otfcc_iFont.consolidate(_font.get(), opts.pimpl.get()->_opts.get());
+        trace_consolidate.end();
+        detail::metrics::add(detail::metrics::counter::modifiersParsed);
     }
 
     ~Impl() = default;
 
 private:
-    struct HLPR_glyphByAW {
-        int32_t origLSB  = 0;
+    // Records why 'sfnt' can't be built from (freeing it), true if it can
+    bool
+    check_sfnt(otfcc_SplineFontContainer *sfnt, uint32_t const ttcindex) {
+        if (! sfnt || sfnt->count == 0) { _failed = err_modifier::sfnt_invalid; }
+        else if (ttcindex >= sfnt->count) { _failed = err_modifier::ttcIndexOutOfRange; }
+        if (not _failed.has_value()) { return true; }
+        if (sfnt) { otfcc_deleteSFNT(sfnt); }
+        return false;
+    }
+
+    void
+    build_andConsolidate(otfcc_SplineFontContainer *sfnt, Options const &opts, uint32_t ttcindex,
+                         detail::_execCheck const &chk = {}, bool const consolidate = true) {
+        // Build font
+        detail::_traceScope trace_build("modifier.buildFont");
+        if (opts.pimpl->_threadCount != 1) { _font = otfcc_Font_uptr(read_fontParallel(sfnt, ttcindex, opts)); }
+        else {
+            otfcc_IFontBuilder *reader = otfcc_newOTFReader();
+            _font = otfcc_Font_uptr(reader->read(sfnt, ttcindex, opts.pimpl.get()->_opts.get()));
+            reader->free(reader);
+        }
+        if (_font && _font->glyf) { trace_build.set_glyphCount(_font->glyf->length); }
+        trace_build.end();
+
+        // Free no longer needed stuff
+        if (sfnt) { otfcc_deleteSFNT(sfnt); }
+        if (! _font) {
+            _failed = err_modifier::font_unreadable;
+            return;
+        }
+
+        _stopped = chk.check();
+        if (_stopped.has_value()) {
+            _font.reset();
+            return;
+        }
+
+        // Consolidate
+        if (consolidate) {
+            detail::_traceScope trace_consolidate("modifier.consolidate");
+            otfcc_iFont.consolidate(_font.get(), opts.pimpl.get()->_opts.get());
+        }
+
+        detail::metrics::add(detail::metrics::counter::modifiersParsed);
+    }
+
+    // The layout tables and 'name' are hidden from otfcc's reader and parsed by otfcc's standalone table readers at
+    // the same time. Everything only reads the SFNT data, the packet's table list is swapped back however this ends.
+    otfcc_Font *
+    read_fontParallel(otfcc_SplineFontContainer *sfnt, uint32_t const ttcindex, Options const &opts) {
+        constexpr std::array detachedTags{detail::sfnt::tag("GSUB"), detail::sfnt::tag("GPOS"),
+                                          detail::sfnt::tag("GDEF"), detail::sfnt::tag("BASE"),
+                                          detail::sfnt::tag("name")};
+        otfcc_Packet const packet = sfnt->packets[ttcindex];
+
+        std::vector<otfcc_PacketPiece> kept;
+        glyphid_t                      numGlyphs = 0;
+        for (uint16_t i = 0; i < packet.numTables; ++i) {
+            otfcc_PacketPiece const &piece = packet.pieces[i];
+            if (piece.tag == detail::sfnt::tag("maxp") && piece.length >= 6) {
+                numGlyphs = static_cast<glyphid_t>((piece.data[4] << 8) | piece.data[5]);
+            }
+            if (std::ranges::find(detachedTags, piece.tag) == detachedTags.end()) { kept.push_back(piece); }
+        }
+        otfcc_Packet mainPacket = packet;
+        mainPacket.numTables    = static_cast<uint16_t>(kept.size());
+        mainPacket.pieces       = kept.data();
+
+        otfcc_Font *font = nullptr;
+        table_OTL  *gsub = nullptr, *gpos = nullptr;
+        table_GDEF *gdef = nullptr;
+        table_BASE *base = nullptr;
+        table_name *name = nullptr;
+
+        // What isn't handed over in the end (eg. when a worker throws) is freed
+        sfnt->packets[ttcindex] = mainPacket;
+        detail::_scopeExit restore([&]() noexcept {
+            sfnt->packets[ttcindex] = packet;
+            if (font) { otfcc_iFont.free(font); }
+            if (gsub) { table_iOTL.free(gsub); }
+            if (gpos) { table_iOTL.free(gpos); }
+            if (gdef) { table_iGDEF.free(gdef); }
+            if (base) { table_iBASE.free(base); }
+            if (name) { table_iName.free(name); }
+        });
+
+        // Slot 0 is otfcc's reader for the rest of the font, the only one using 'opts' itself
+        detail::parallel_for(
+            detachedTags.size() + 1, 1,
+            [&](size_t const begin, size_t const end) {
+                for (size_t i = begin; i < end; ++i) {
+                    if (i == 0) {
+                        otfcc_IFontBuilder *reader = otfcc_newOTFReader();
+                        font = reader->read(sfnt, ttcindex, opts.pimpl.get()->_opts.get());
+                        reader->free(reader);
+                        continue;
+                    }
+                    _threadOptions topts(*opts.pimpl->_opts);
+                    switch (i) {
+                        case 1: gsub = otfcc_readOtl(packet, &topts.opts, detachedTags[0], numGlyphs); break;
+                        case 2: gpos = otfcc_readOtl(packet, &topts.opts, detachedTags[1], numGlyphs); break;
+                        case 3: gdef = otfcc_readGDEF(packet, &topts.opts); break;
+                        case 4: base = otfcc_readBASE(packet, &topts.opts); break;
+                        case 5: name = otfcc_readName(packet, &topts.opts); break;
+                        default: break;
+                    }
+                }
+            },
+            opts.pimpl->_threadCount);
+
+        if (! font) { return nullptr; }
+        font->GSUB = std::exchange(gsub, nullptr);
+        font->GPOS = std::exchange(gpos, nullptr);
+        font->GDEF = std::exchange(gdef, nullptr);
+        font->BASE = std::exchange(base, nullptr);
+        font->name = std::exchange(name, nullptr);
+        return std::exchange(font, nullptr);
+    }
+
+    struct HLPR_glyphByAW {
+        int32_t origLSB  = 0;
         int32_t movedByH = 0;
     };
 
@@ -538,19 +1225,37 @@ private:
         if (not _font->glyf) { return std::unexpected(err_modifier::unexpectedNullptr); }
         if (newEmSize < 0) { return std::unexpected(err_modifier::newEmSize_outsideValidValueRange); }
 
+        auto glyfVec = wrappers::CV_wrapper<table_glyf, glyf_GlyphPtr>(*_font->glyf);
+
+        // Nothing is changed yet, stopping here leaves the font as it was
+        if (auto const e = checkpoint("change_unitsPerEm", "glyphs", 0, glyfVec.size())) {
+            return std::unexpected(e.value());
+        }
+
         double const a = (static_cast<double>(newEmSize) / _font->head->unitsPerEm), b = 0, c = 0, d = a, dx = 0,
                      dy         = 0;
         _font->head->unitsPerEm = newEmSize;
 
-        auto   glyfVec = wrappers::CV_wrapper<table_glyf, glyf_GlyphPtr>(*_font->glyf);
-        size_t res     = 0uz;
+        detail::_traceScope trace("modifier.transformGlyphs.unitsPerEm");
+        trace.set_glyphCount(_font->glyf->length);
+
+        size_t res  = 0uz;
+        size_t done = 0uz;
         for (auto one_oe_glyph : glyfVec) {
             if (auto oneTransformRes = transform_glyphSize(one_oe_glyph, a, b, c, d, dx, dy);
                 not oneTransformRes.has_value()) {
                 return std::unexpected(oneTransformRes.error());
             }
             else { res += oneTransformRes.value(); }
+
+            if (++done % _glyphBatch == 0 && done < glyfVec.size()) {
+                if (auto const e = checkpoint("change_unitsPerEm", "glyphs", done, glyfVec.size())) {
+                    _mustDiscard = true;
+                    return std::unexpected(e.value());
+                }
+            }
         }
+        report_progress("change_unitsPerEm", "glyphs", done, glyfVec.size());
 
         if (auto res_loc = _pureScale_AscDescLG(a); not res_loc.has_value()) {
             return std::unexpected(res_loc.error());
@@ -567,24 +1272,25 @@ private:
         if (not _font->head) { return std::unexpected(err_modifier::unexpectedNullptr); }
         if (not _font->glyf) { return std::unexpected(err_modifier::unexpectedNullptr); }
 
-        std::unordered_map<glyphid_t, int32_t>       res{};
-        std::unordered_set<glyphid_t>                cycleChecker{};
-        std::unordered_map<glyphid_t, glyf_GlyphPtr> mapOfRefs{};
+        detail::_traceScope trace("modifier.transformGlyphs.advanceWidth");
+        trace.set_glyphCount(_font->glyf->length);
 
         auto glyfVec = wrappers::CV_wrapper<table_glyf, glyf_GlyphPtr>(*_font->glyf);
 
-        for (glyphid_t id = 0; auto glyf : glyfVec) { mapOfRefs.emplace(id++, glyf); }
+        // Sized once up front, the solver itself doesn't allocate apart from the nodes of 'res'
+        std::unordered_map<glyphid_t, int32_t> res{};
+        res.reserve(glyfVec.size());
+        std::vector<bool> cycleChecker(glyfVec.size(), false);
 
         auto recSolver = [&](this auto const &self, glyphid_t const toSolve) -> std::expected<int32_t, err_modifier> {
-            if (cycleChecker.contains(toSolve)) { return std::unexpected(err_modifier::cyclicGlyfReferencesFound); }
+            // Get the object we are supposed to be solving
+            if (toSolve >= glyfVec.size()) { return std::unexpected(err_modifier::missingGlyphInGlyfTable); }
+            if (cycleChecker[toSolve]) { return std::unexpected(err_modifier::cyclicGlyfReferencesFound); }
 
             // If it has been solved already, we just return the result stored in res
             if (auto found = res.find(toSolve); found != res.end()) { return found->second; }
 
-            // Get the object we are supposed to be solving
-            auto ite = mapOfRefs.find(toSolve);
-            if (ite == mapOfRefs.end()) { return std::unexpected(err_modifier::missingGlyphInGlyfTable); }
-            auto solveObj = ite->second;
+            auto solveObj = glyfVec[toSolve];
             if (solveObj == nullptr) { return std::unexpected(err_modifier::unexpectedNullptr); }
 
             // Get advanceWidth
@@ -608,10 +1314,9 @@ private:
             auto refesObj = wrappers::CV_wrapper<glyf_ReferenceList, glyf_ComponentReference>(solveObj->references);
             if (not refesObj.empty()) {
 
-                cycleChecker.insert(toSolve);
-                std::vector<int32_t> glyphHLPRs;
+                cycleChecker[toSolve] = true;
 
-                for (auto const &oneRef : refesObj) {
+                for (auto &oneRef : refesObj) {
                     if (oneRef.glyph.state != handle_state::HANDLE_STATE_CONSOLIDATED &&
                         oneRef.glyph.state != handle_state::HANDLE_STATE_INDEX) {
                         return std::unexpected(err_modifier::otfccHandle_notIndex);
@@ -621,17 +1326,12 @@ private:
                     auto refGlyphHLPR = self(oneRef.glyph.index);
                     if (not refGlyphHLPR.has_value()) { return std::unexpected(refGlyphHLPR.error()); }
 
-                    glyphHLPRs.push_back(refGlyphHLPR.value());
-                }
-
-                for (size_t i = 0; auto &oneRef : refesObj) {
                     // Move the anchors for references by moveBy but exclude the move already done inside the refed
                     // glyph
-                    oneRef.x.kernel += (moveBy - glyphHLPRs.at(i));
-                    i++;
+                    oneRef.x.kernel += (moveBy - refGlyphHLPR.value());
                 }
 
-                if (cycleChecker.erase(toSolve) != 1uz) { return std::unexpected(err_modifier::unknownError); }
+                cycleChecker[toSolve] = false;
             }
 
             // Update the actual advance width value in the glyph
@@ -646,11 +1346,23 @@ private:
         };
 
         // EXECUTING SOLVER
-        for (auto onePair = mapOfRefs.begin(); onePair != mapOfRefs.end(); ++onePair) {
-            // Exec for one glyph name
-            auto solveRes = recSolver(onePair->first);
+        if (auto const e = checkpoint("change_makeMonospaced", "glyphs", 0, glyfVec.size())) {
+            return std::unexpected(e.value());
+        }
+        for (size_t id = 0; id < glyfVec.size(); ++id) {
+            // Exec for one glyph
+            auto solveRes = recSolver(static_cast<glyphid_t>(id));
             if (not solveRes.has_value()) { return std::unexpected(solveRes.error()); }
+
+            // Referenced glyphs may already be solved ahead of 'id', what matters is that the glyphs after it aren't
+            if ((id + 1) % _glyphBatch == 0 && id + 1 < glyfVec.size()) {
+                if (auto const e = checkpoint("change_makeMonospaced", "glyphs", id + 1, glyfVec.size())) {
+                    _mustDiscard = true;
+                    return std::unexpected(e.value());
+                }
+            }
         }
+        report_progress("change_makeMonospaced", "glyphs", glyfVec.size(), glyfVec.size());
 
         return res;
     }
@@ -662,13 +1374,54 @@ private:
         otfcc_iFont.deleteTable(_font.get(), tag);
         return true;
     }
+    std::expected<bool, err_modifier>
+    remove_tablesByProfile(TableProfile const &profile) {
+        if (not _font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+
+        // Instructions left without their 'fpgm' or 'cvt ' break the rasterizer, they go along. They go first, a stop
+        // in between leaves the tables they use in place.
+        bool const dropsHinting = detail::table_profile::drops_hinting(profile);
+        if (dropsHinting) {
+            if (auto exp_res = remove_glyphInstructions(); not exp_res.has_value()) { return exp_res; }
+        }
+        detail::table_profile::apply(*_font, profile);
+        if (dropsHinting) {
+            otfcc_iFont.deleteTable(_font.get(), std::to_underlying(otfcc_glyfTable_nameMapping::fpgm));
+            otfcc_iFont.deleteTable(_font.get(), std::to_underlying(otfcc_glyfTable_nameMapping::prep));
+            otfcc_iFont.deleteTable(_font.get(), std::to_underlying(otfcc_glyfTable_nameMapping::cvt));
+        }
+        return true;
+    }
 
     std::expected<bool, err_modifier>
     remove_ttfHints_all() {
+        if (auto exp_res = remove_glyphInstructions(); not exp_res.has_value()) { return exp_res; }
+
+        std::expected<bool, err_modifier> res;
+        res = remove_tableByTag(std::to_underlying(otfcc_glyfTable_nameMapping::fpgm));
+        res = remove_tableByTag(std::to_underlying(otfcc_glyfTable_nameMapping::prep));
+        res = remove_tableByTag(std::to_underlying(otfcc_glyfTable_nameMapping::cvt));
+        res = remove_tableByTag(std::to_underlying(otfcc_glyfTable_nameMapping::gasp));
+        return true;
+    }
+
+    std::expected<bool, err_modifier>
+    remove_glyphInstructions() {
         if (not _font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+        if (not _font->glyf) { return true; }
         auto glyfsVec = wrappers::CV_wrapper<table_glyf, glyf_GlyphPtr>(*_font->glyf);
 
+        // Stopping anywhere here is safe as long as 'fpgm', 'prep' and 'cvt ' are still there, glyphs without
+        // instructions are valid. Another call finishes the job.
+        size_t done = 0uz;
         for (auto oneGlyph : glyfsVec) {
+            if (done % _glyphBatch == 0) {
+                if (auto const e = checkpoint("remove_ttfHints", "glyphs", done, glyfsVec.size())) {
+                    return std::unexpected(e.value());
+                }
+            }
+            ++done;
+
             if (not oneGlyph) { return std::unexpected(err_modifier::unexpectedNullptr); }
             oneGlyph->instructionsLength = 0;
 
@@ -680,35 +1433,290 @@ private:
                 }
             }
         }
-
-        std::expected<bool, err_modifier> res;
-        res = remove_tableByTag(std::to_underlying(otfcc_glyfTable_nameMapping::fpgm));
-        res = remove_tableByTag(std::to_underlying(otfcc_glyfTable_nameMapping::prep));
-        res = remove_tableByTag(std::to_underlying(otfcc_glyfTable_nameMapping::cvt));
-        res = remove_tableByTag(std::to_underlying(otfcc_glyfTable_nameMapping::gasp));
+        report_progress("remove_ttfHints", "glyphs", done, glyfsVec.size());
         return true;
     }
 
+    std::expected<size_t, err_modifier>
+    keep_glyphsReachable(std::span<const CPRange> const cps) {
+        if (not _font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+        if (not _font->glyf) { return std::unexpected(err_modifier::unexpectedNullptr); }
+        detail::_traceScope trace("modifier.keepGlyphs");
+        trace.set_glyphCount(_font->glyf->length);
+
+        // The font only changes in the last stage, which isn't interruptible
+        constexpr size_t stageCount = 2;
+        if (auto const e = checkpoint("keep_glyphs", "closure", 0, stageCount)) { return std::unexpected(e.value()); }
+        auto exp_keep = detail::glyph_closure::reachable(*_font, cps);
+        if (not exp_keep.has_value()) {
+            switch (exp_keep.error()) {
+                case detail::glyph_closure::error::missingGlyph:
+                    return std::unexpected(err_modifier::missingGlyphInGlyfTable);
+                case detail::glyph_closure::error::handleNotIndex:
+                    return std::unexpected(err_modifier::otfccHandle_notIndex);
+            }
+            std::unreachable();
+        }
+
+        if (auto const e = checkpoint("keep_glyphs", "renumber", 1, stageCount)) { return std::unexpected(e.value()); }
+        size_t const kept = detail::glyph_closure::retain(*_font, exp_keep.value(), cps);
+
+        // Renumbers the glyphs and drops what pointed to the deleted ones, the transforms need the new indices
+        Options const opts(0, false);
+        otfcc_iFont.consolidate(_font.get(), opts.pimpl.get()->_opts.get());
+        report_progress("keep_glyphs", "renumber", stageCount, stageCount);
+        return kept;
+    }
+
+    std::expected<size_t, err_modifier>
+    merge_glyphsFrom(Impl const &other) {
+        if (not _font || not other._font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+        if (not _font->head || not other._font->head) { return std::unexpected(err_modifier::unexpectedNullptr); }
+        detail::_traceScope trace("modifier.mergeGlyphs");
+
+        // 'other' stays as it is, a differently sized one is scaled on a copy
+        otfcc_Font const     *src = other._font.get();
+        std::unique_ptr<Impl> scaled;
+        if (other._font->head->unitsPerEm != _font->head->unitsPerEm) {
+            scaled = std::make_unique<Impl>(other, clone_t{});
+            if (not scaled->_font) { return std::unexpected(err_modifier::clone_failed); }
+            scaled->_ctl      = _ctl;
+            scaled->_progress = {};
+            auto exp_res      = scaled->transform_allGlyphsSize(_font->head->unitsPerEm);
+            if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+            src = scaled->_font.get();
+        }
+
+        auto exp_added = detail::font_merge::append(*_font, *src);
+        if (not exp_added.has_value()) {
+            switch (exp_added.error()) {
+                case detail::font_merge::error::missingGlyph:
+                    return std::unexpected(err_modifier::missingGlyphInGlyfTable);
+                case detail::font_merge::error::handleNotIndex:
+                    return std::unexpected(err_modifier::otfccHandle_notIndex);
+                case detail::font_merge::error::cffOutlines:
+                    return std::unexpected(err_modifier::merge_cffOutlines);
+                case detail::font_merge::error::outOfMemory:
+                    return std::unexpected(err_modifier::unexpectedNullptr);
+            }
+            std::unreachable();
+        }
+        if (_font->glyf) { trace.set_glyphCount(_font->glyf->length); }
+
+        // The added glyphs and cmap entries refer to glyphs by name until then
+        Options const opts(0, false);
+        otfcc_iFont.consolidate(_font.get(), opts.pimpl.get()->_opts.get());
+        return exp_added.value();
+    }
+
 
     // Export
     std::expected<Bytes, err_modifier>
-    exportResult(Options const &opts) {
-
-        // 'Finalize' font for export. IE. Do the things that the underlying otfcc library doesn't do
-        auto preExp_res = _preExport_finalize();
-        if (not preExp_res.has_value()) { return std::unexpected(preExp_res.error()); }
+    exportResult(Options const &opts, detail::_execCheck const &chk) {
+        detail::metrics::_latencyScope latency(detail::metrics::histogram::exportLatency_us);
 
+        // None of the stages changes the font in a way that matters when stopped in between. There is no finalization
+        // (see _preExport_finalize()), otfcc's writer measures the glyphs and derives 'head', 'hhea' and 'maxp' itself.
+        constexpr size_t stageCount = 2;
         if (! _font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+        if (auto const e = checkpoint("exportResult", "consolidate", 0, stageCount, chk)) {
+            return std::unexpected(e.value());
+        }
 
+        detail::_traceScope trace_consolidate("modifier.consolidate");
         otfcc_iFont.consolidate(_font.get(), opts.pimpl.get()->_opts.get());
+        trace_consolidate.end();
+        if (auto const e = checkpoint("exportResult", "serialize", 1, stageCount, chk)) {
+            return std::unexpected(e.value());
+        }
+
+        detail::_traceScope trace_serialize("modifier.serialize");
+        auto                exp_res = serialize_sfnt(opts);
+        if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+        Bytes res = std::move(exp_res.value());
+
+        trace_serialize.set_bytesOut(res.size());
+        report_progress("exportResult", "serialize", stageCount, stageCount);
+        detail::metrics::add(detail::metrics::counter::exportsCompleted);
+        detail::metrics::add(detail::metrics::counter::exportBytesOut, res.size());
+        if (_font->glyf) { trace_serialize.set_glyphCount(_font->glyf->length); }
+        return res;
+    }
+
+
+    // The font must be consolidated
+    std::expected<Bytes, err_modifier>
+    serialize_sfnt(Options const &opts) {
+        if (opts.pimpl->_threadCount != 1) { return serialize_sfnt_parallel(opts); }
 
         otfcc_IFontSerializer *writer = otfcc_newOTFWriter();
         caryll_Buffer         *otf    = (caryll_Buffer *)writer->serialize(_font.get(), opts.pimpl.get()->_opts.get());
+        writer->free(writer);
         if (! otf) { return std::unexpected(err_modifier::unexpectedNullptr); }
 
         Bytes res(otf->size);
         std::memcpy(res.data(), otf->data, otf->size);
+        buffree(otf);
+        return res;
+    }
+
+    // otfcc's loggers keep state, every thread building tables needs its own (set up like in Options::Impl)
+    struct _threadOptions {
+        explicit _threadOptions(otfcc_Options const &src) : opts(src) {
+            opts.logger = otfcc_newLogger(otfcc_newStdErrTarget());
+            opts.logger->indent(opts.logger, "[missing]");
+        }
+        ~_threadOptions() { opts.logger->dispose(opts.logger); }
+
+        _threadOptions(const _threadOptions &) = delete;
+        _threadOptions &
+        operator=(const _threadOptions &) = delete;
+
+        otfcc_Options opts;
+    };
+
+    // The layout tables and 'name' are taken out of the font and built by otfcc's standalone table builders, while
+    // otfcc's writer builds everything else at the same time. The pieces are then put together into one SFNT with
+    // fresh checksums. The writer doesn't see the layout tables, OS/2 usMaxContext is computed from the detached ones.
+    // The font gets its tables back however this ends.
+    std::expected<Bytes, err_modifier>
+    serialize_sfnt_parallel(Options const &opts) {
+        struct detached_table {
+            uint32_t                                                 tag;
+            std::move_only_function<caryll_Buffer *(otfcc_Options *)> build;
+            caryll_Buffer                                           *out = nullptr;
+        };
 
+        table_OTL  *gsub = std::exchange(_font->GSUB, nullptr);
+        table_OTL  *gpos = std::exchange(_font->GPOS, nullptr);
+        table_GDEF *gdef = std::exchange(_font->GDEF, nullptr);
+        table_BASE *base = std::exchange(_font->BASE, nullptr);
+        table_name *name = std::exchange(_font->name, nullptr);
+        detail::_scopeExit restore([&]() noexcept {
+            _font->GSUB = gsub;
+            _font->GPOS = gpos;
+            _font->GDEF = gdef;
+            _font->BASE = base;
+            _font->name = name;
+        });
+
+        std::vector<detached_table> detached;
+        if (gsub) {
+            detached.push_back({detail::sfnt::tag("GSUB"), [=](otfcc_Options *o) {
+                                    return otfcc_buildOtl(gsub, o, "GSUB");
+                                }});
+        }
+        if (gpos) {
+            detached.push_back({detail::sfnt::tag("GPOS"), [=](otfcc_Options *o) {
+                                    return otfcc_buildOtl(gpos, o, "GPOS");
+                                }});
+        }
+        if (gdef) {
+            detached.push_back({detail::sfnt::tag("GDEF"), [=](otfcc_Options *o) { return otfcc_buildGDEF(gdef, o); }});
+        }
+        if (base) {
+            detached.push_back({detail::sfnt::tag("BASE"), [=](otfcc_Options *o) { return otfcc_buildBASE(base, o); }});
+        }
+        if (name) {
+            detached.push_back({detail::sfnt::tag("name"), [=](otfcc_Options *o) { return otfcc_buildName(name, o); }});
+        }
+        uint16_t const maxContext = detail::font_metrics::max_context(gsub, gpos);
+
+        // Slot 0 is otfcc's writer for the rest of the font, the only one using 'opts' itself
+        caryll_Buffer     *rest = nullptr;
+        detail::_scopeExit freeAll([&]() noexcept {
+            if (rest) { buffree(rest); }
+            for (auto &dt : detached) {
+                if (dt.out) { buffree(dt.out); }
+            }
+        });
+        detail::parallel_for(
+            detached.size() + 1, 1,
+            [&](size_t const begin, size_t const end) {
+                for (size_t i = begin; i < end; ++i) {
+                    if (i == 0) {
+                        otfcc_IFontSerializer *writer = otfcc_newOTFWriter();
+                        rest = (caryll_Buffer *)writer->serialize(_font.get(), opts.pimpl.get()->_opts.get());
+                        writer->free(writer);
+                        continue;
+                    }
+                    _threadOptions topts(*opts.pimpl->_opts);
+                    detached[i - 1].out = detached[i - 1].build(&topts.opts);
+                }
+            },
+            opts.pimpl->_threadCount);
+        if (! rest) { return std::unexpected(err_modifier::unexpectedNullptr); }
+
+        auto exp_split = detail::sfnt::split(ByteSpan(reinterpret_cast<std::byte const *>(rest->data), rest->size));
+        if (not exp_split.has_value()) { return std::unexpected(err_modifier::unknownError); }
+        detail::sfnt::font assembled = std::move(exp_split.value());
+
+        // Only from version 2 on OS/2 is long enough to have usMaxContext
+        Bytes os2;
+        for (auto &tbl : assembled.tables) {
+            if (tbl.tag != detail::sfnt::tag("OS/2") || tbl.data.size() < 96) { continue; }
+            os2.assign(tbl.data.begin(), tbl.data.end());
+            os2[94]  = static_cast<std::byte>(maxContext >> 8);
+            os2[95]  = static_cast<std::byte>(maxContext & 0xFF);
+            tbl.data = os2;
+        }
+        for (auto const &dt : detached) {
+            if (! dt.out || dt.out->size == 0) { continue; }
+            assembled.tables.push_back(
+                {dt.tag, ByteSpan(reinterpret_cast<std::byte const *>(dt.out->data), dt.out->size)});
+        }
+
+        return detail::sfnt::assemble(assembled);
+    }
+
+    std::expected<Bytes, err_modifier>
+    save_snapshot() {
+        if (! _font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+        detail::_traceScope trace("modifier.saveSnapshot");
+
+        // No optimizations, the snapshot is an intermediate that gets exported (and optimized) later
+        Options const opts(0, false);
+        otfcc_iFont.consolidate(_font.get(), opts.pimpl.get()->_opts.get());
+        auto exp_sfnt = serialize_sfnt(opts);
+        if (not exp_sfnt.has_value()) { return std::unexpected(exp_sfnt.error()); }
+
+        Bytes res;
+        res.reserve(snapshot_fmt::headerSize + exp_sfnt->size());
+        for (char const c : snapshot_fmt::magic) { res.push_back(static_cast<std::byte>(c)); }
+        snapshot_fmt::put_le(res, snapshot_fmt::version, 4);
+        snapshot_fmt::put_le(res, _sourceFingerprint, 8);
+        snapshot_fmt::put_le(res, exp_sfnt->size(), 8);
+        snapshot_fmt::put_le(res, detail::xxh64::hash(exp_sfnt.value()), 8);
+        res.insert(res.end(), exp_sfnt->begin(), exp_sfnt->end());
+        trace.set_bytesOut(res.size());
+        return res;
+    }
+
+
+    std::expected<size_t, err_modifier>
+    export_json(std::function<void(std::string_view)> const &sink, bool const pretty) {
+        if (! _font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+
+        // Consolidated the same way save_snapshot() does it, the JSON is meant to come back through from_json()
+        Options const opts(0, false);
+        otfcc_iFont.consolidate(_font.get(), opts.pimpl.get()->_opts.get());
+
+        // The dumper writes the glyph bounds and derived values as they are, unlike otfcc's SFNT writer
+        auto preExp_res = _preExport_finalize(opts.pimpl->_threadCount);
+        if (not preExp_res.has_value()) { return std::unexpected(preExp_res.error()); }
+
+        detail::_traceScope    trace_dump("modifier.dumpJSON");
+        otfcc_IFontSerializer *dumper = otfcc_newJsonWriter();
+        json_value_uptr        root(
+            static_cast<json_value *>(dumper->serialize(_font.get(), opts.pimpl.get()->_opts.get())));
+        dumper->free(dumper);
+        if (! root) { return std::unexpected(err_modifier::unexpectedNullptr); }
+        if (_font->glyf) { trace_dump.set_glyphCount(_font->glyf->length); }
+        trace_dump.end();
+
+        detail::_traceScope trace_write("modifier.writeJSON");
+        size_t const        res = detail::json_stream::write(*root, pretty, sink);
+        trace_write.set_bytesOut(res);
         return res;
     }
 
@@ -787,29 +1795,133 @@ private:
     }
 
 
-    // MANDATORY TO IMPLEMENT BEFORE RELEASE
+    // Glyph bounds and the 'head', 'hhea' and 'maxp' values derived from them, stale after the transforms above.
+    // Only needed where otfcc doesn't recompute them, ie. the JSON dump. The font must be consolidated (that drops
+    // dangling references). Measured on 'threadCount' threads. Returns the number of glyphs measured.
     std::expected<size_t, err_modifier>
-    _preExport_finalize() {
-        return 0uz;
+    _preExport_finalize(size_t const threadCount) {
+        if (not _font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+
+        detail::_traceScope trace("modifier.finalize");
+        if (_font->glyf) { trace.set_glyphCount(_font->glyf->length); }
+
+        auto exp_res = detail::font_metrics::recompute(*_font, threadCount);
+        if (not exp_res.has_value()) {
+            switch (exp_res.error()) {
+                case detail::font_metrics::error::missingGlyph:
+                    return std::unexpected(err_modifier::missingGlyphInGlyfTable);
+                case detail::font_metrics::error::handleNotIndex:
+                    return std::unexpected(err_modifier::otfccHandle_notIndex);
+                case detail::font_metrics::error::cyclicReference:
+                    return std::unexpected(err_modifier::cyclicGlyfReferencesFound);
+            }
+            std::unreachable();
+        }
+        return exp_res.value();
+    }
+
+
+    // Cooperative cancellation and progress of the long running operations
+    void
+    report_progress(std::string_view const operation, std::string_view const stage, size_t const done,
+                    size_t const total) const {
+        if (_progress) { _progress(ModifierProgress{operation, stage, done, total}); }
+    }
+    std::optional<err_modifier>
+    checkpoint(std::string_view const operation, std::string_view const stage, size_t const done, size_t const total,
+               detail::_execCheck const &chk) const {
+        report_progress(operation, stage, done, total);
+        return chk.check().transform(detail::to_err<err_modifier>);
+    }
+    std::optional<err_modifier>
+    checkpoint(std::string_view const operation, std::string_view const stage, size_t const done,
+               size_t const total) const {
+        return checkpoint(operation, stage, done, total, detail::_execCheck(_ctl));
     }
 
 
 private:
     otfcc_Font_uptr _font;
+
+    // Why an interruptible construction stopped early (the font is then missing)
+    std::optional<detail::exec_stop> _stopped;
+    // Why construction failed otherwise (the font is then missing too)
+    std::optional<err_modifier> _failed;
+
+    ExecControl      _ctl;
+    ProgressCallback _progress;
+    uint32_t         _glyphBatch  = 1024;
+    bool             _mustDiscard = false; // An operation stopped halfway through changing the glyphs
+
+    uint64_t _sourceFingerprint = 0; // Of the font this was created from, 0 if unknown
 };
 
 
 Modifier::Modifier(ByteSpan raw_ttfFont, uint32_t ttcindex, Options const &opts)
-    : pimpl(std::make_unique<Impl>(raw_ttfFont, opts, ttcindex)) {}
+    : pimpl(std::make_unique<Impl>(raw_ttfFont, opts, ttcindex)) {
+    pimpl->_sourceFingerprint = detail::xxh64::hash(raw_ttfFont);
+}
 
 Modifier::Modifier(std::filesystem::path const &pth, uint32_t ttcindex, Options const &opts)
     : pimpl(std::make_unique<Impl>(pth, opts, ttcindex)) {}
 
-Modifier::~Modifier() = default;
+Modifier::Modifier(FontSource const &src, uint32_t ttcindex, Options const &opts)
+    : pimpl(std::make_unique<Impl>(src.bytes(), opts, ttcindex)) {
+    pimpl->_sourceFingerprint = src.fingerprint();
+}
+
+Modifier::Modifier(std::unique_ptr<Impl> impl) noexcept : pimpl(std::move(impl)) {}
+
+Modifier::~Modifier()                    = default;
+Modifier::Modifier(Modifier &&) noexcept = default;
+Modifier &
+Modifier::operator=(Modifier &&) noexcept = default;
+
+std::expected<Modifier, err_modifier>
+Modifier::create(ByteSpan const raw_ttfFont, uint32_t const ttcindex, Options const &opts) {
+    auto impl = std::make_unique<Impl>(raw_ttfFont, opts, ttcindex);
+    if (impl->_failed.has_value()) { return std::unexpected(impl->_failed.value()); }
+    impl->_sourceFingerprint = detail::xxh64::hash(raw_ttfFont);
+    return Modifier(std::move(impl));
+}
+
+std::future<std::expected<Modifier, err_modifier>>
+Modifier::create_async(FontSource src, uint32_t ttcindex, Options opts, ExecControl ctl, Executor &exec) {
+    return detail::submit_async(exec, [src = std::move(src), ttcindex, opts = std::move(opts),
+                                       ctl = std::move(ctl)]() -> std::expected<Modifier, err_modifier> {
+        auto impl = std::make_unique<Impl>(src.bytes(), opts, ttcindex, detail::_execCheck(ctl));
+        if (impl->_stopped.has_value()) {
+            return std::unexpected(detail::to_err<err_modifier>(impl->_stopped.value()));
+        }
+        if (impl->_failed.has_value()) { return std::unexpected(impl->_failed.value()); }
+        return Modifier(std::move(impl));
+    });
+}
+
+// Cancellation and progress
+Modifier &
+Modifier::set_execControl(ExecControl ctl) {
+    if (pimpl) { pimpl->_ctl = std::move(ctl); }
+    return *this;
+}
+Modifier &
+Modifier::set_progressCallback(ProgressCallback cb, uint32_t const glyphBatch) {
+    if (! pimpl) { return *this; }
+    pimpl->_progress   = std::move(cb);
+    pimpl->_glyphBatch = std::max(1u, glyphBatch);
+    return *this;
+}
+bool
+Modifier::must_discard() const noexcept {
+    return pimpl && pimpl->_mustDiscard;
+}
 
 // Changing dimensions of glyphs
 std::expected<bool, err_modifier>
 Modifier::change_unitsPerEm(uint32_t newEmSize) {
+    detail::_allocScope allocs("Modifier::change_unitsPerEm");
+    if (! pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
     auto exp_res = pimpl->transform_allGlyphsSize(newEmSize);
     if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
     return true;
@@ -817,6 +1929,9 @@ Modifier::change_unitsPerEm(uint32_t newEmSize) {
 
 std::expected<bool, err_modifier>
 Modifier::change_makeMonospaced(uint32_t const targetAdvWidth) {
+    detail::_allocScope allocs("Modifier::change_makeMonospaced");
+    if (! pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
     auto exp_res = pimpl->transform_allGlyphsByAW(targetAdvWidth, Modifier::Impl::_Detail::default_ksADW);
     if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
     return true;
@@ -826,6 +1941,7 @@ Modifier::change_makeMonospaced_byEmRatio(double const emRatio) {
     if (emRatio > 2.0) { return std::unexpected(err_modifier::ratioAdvWidthToEmSize_cannotBeOver2); }
     if (emRatio < 0.0) { return std::unexpected(err_modifier::ratioAdvWidthToEmSize_cannotBeNegative); }
 
+    if (! pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
     if (not pimpl->_font) { return std::unexpected(err_modifier::unexpectedNullptr); }
     if (not pimpl->_font->head) { return std::unexpected(err_modifier::unexpectedNullptr); }
 
@@ -833,21 +1949,267 @@ Modifier::change_makeMonospaced_byEmRatio(double const emRatio) {
 }
 
 // Filtering of font content (ie. deleting parts of the font)
+void
+Modifier::delete_fontTable(const uint32_t tag) {
+    if (! pimpl || pimpl->_mustDiscard) { return; }
+    pimpl->remove_tableByTag(tag);
+}
+std::expected<bool, err_modifier>
+Modifier::apply_tableProfile(TableProfile const &profile) {
+    if (! pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
+    return pimpl->remove_tablesByProfile(profile);
+}
 
+std::expected<size_t, err_modifier>
+Modifier::keep_glyphsForCPs(std::span<const uint32_t> cps) {
+    std::vector<CPRange> ranges;
+    ranges.reserve(cps.size());
+    for (uint32_t const cp : cps) { ranges.push_back(CPRange{cp, cp}); }
+    return keep_glyphsForCPRanges(ranges);
+}
+std::expected<size_t, err_modifier>
+Modifier::keep_glyphsForCPRanges(std::span<const CPRange> ranges) {
+    detail::_allocScope allocs("Modifier::keep_glyphs");
+    if (! pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
+    return pimpl->keep_glyphsReachable(ranges);
+}
 
 // Modifications of other values and properties
 
 // THIS FUNCTION IS FAKE
 std::expected<bool, err_modifier>
 Modifier::remove_ttfHints() {
+    detail::_allocScope allocs("Modifier::remove_ttfHints");
+    if (! pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
     return pimpl->remove_ttfHints_all();
 }
 
+std::expected<bool, err_modifier>
+Modifier::apply_recipe(ModifierRecipe const &recipe) {
+    if (! pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (recipe.unitsPerEm.has_value()) {
+        auto exp_res = change_unitsPerEm(recipe.unitsPerEm.value());
+        if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+    }
+    if (recipe.monospacedAdvWidth.has_value()) {
+        auto exp_res = change_makeMonospaced(recipe.monospacedAdvWidth.value());
+        if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+    }
+    else if (recipe.monospacedEmRatio.has_value()) {
+        auto exp_res = change_makeMonospaced_byEmRatio(recipe.monospacedEmRatio.value());
+        if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+    }
+    if (recipe.removeTTFHints) {
+        auto exp_res = remove_ttfHints();
+        if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+    }
+    if (recipe.tableProfile.has_value()) {
+        auto exp_res = apply_tableProfile(recipe.tableProfile.value());
+        if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+    }
+    return true;
+}
+
+// Merging of fonts
+std::expected<size_t, err_modifier>
+Modifier::merge_glyphsFrom(Modifier const &other) {
+    detail::_allocScope allocs("Modifier::merge_glyphsFrom");
+    if (! pimpl || ! other.pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (pimpl->_mustDiscard || other.pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
+    return pimpl->merge_glyphsFrom(*other.pimpl);
+}
+
 // Export
 std::expected<Bytes, err_modifier>
 Modifier::exportResult(Options const &opts) {
+    detail::_allocScope allocs("Modifier::exportResult");
+    if (! pimpl || ! opts.pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
+    return pimpl->exportResult(opts, detail::_execCheck(pimpl->_ctl));
+}
+std::future<std::expected<Bytes, err_modifier>>
+Modifier::exportResult_async(Modifier modi, Options opts, ExecControl ctl, Executor &exec) {
+    return detail::submit_async(exec, [modi = std::move(modi), opts = std::move(opts), ctl = std::move(ctl)]() mutable
+                                -> std::expected<Bytes, err_modifier> {
+        detail::_allocScope allocs("Modifier::exportResult");
+        if (! modi.pimpl || ! opts.pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+        if (modi.pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
+        return modi.pimpl->exportResult(opts, detail::_execCheck(ctl));
+    });
+}
+
+std::expected<Modifier, err_modifier>
+Modifier::clone() const {
+    if (! pimpl || ! pimpl->_font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
+
+    auto impl = std::make_unique<Impl>(*pimpl, Impl::clone_t{});
+    if (! impl->_font) { return std::unexpected(err_modifier::clone_failed); }
+    return Modifier(std::move(impl));
+}
+
+// Variants
+std::vector<std::future<std::expected<Bytes, err_modifier>>>
+Modifier::submit_variants(std::shared_ptr<const Impl> base, std::vector<ModifierRecipe> recipes,
+                          ExecControl const &ctl, Executor &exec) {
+    std::vector<std::future<std::expected<Bytes, err_modifier>>> res;
+    res.reserve(recipes.size());
+    for (auto &recipe : recipes) {
+        res.push_back(detail::submit_async(exec, [base, recipe = std::move(recipe), ctl]()
+                                           -> std::expected<Bytes, err_modifier> {
+            detail::_allocScope allocs("Modifier::export_variants");
+            if (! base || ! base->_font) { return std::unexpected(err_modifier::unexpectedNullptr); }
+            if (base->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
+            if (auto const stop = detail::_execCheck(ctl).check(); stop.has_value()) {
+                return std::unexpected(detail::to_err<err_modifier>(stop.value()));
+            }
+
+            auto impl = std::make_unique<Impl>(*base, Impl::clone_t{});
+            if (! impl->_font) { return std::unexpected(err_modifier::clone_failed); }
+            Modifier variant(std::move(impl));
+            // Several variants run at once, the base's callback isn't made for that
+            variant.pimpl->_progress = {};
+            variant.pimpl->_ctl      = ctl;
+
+            auto exp_res = variant.apply_recipe(recipe);
+            if (not exp_res.has_value()) { return std::unexpected(exp_res.error()); }
+            return variant.exportResult(recipe.exportOpts);
+        }));
+    }
+    return res;
+}
+
+std::vector<std::future<std::expected<Bytes, err_modifier>>>
+Modifier::exportVariants_async(Modifier base, std::vector<ModifierRecipe> recipes, ExecControl ctl, Executor &exec) {
+    // Owned by the tasks together, freed after the last one finished
+    return submit_variants(std::shared_ptr<const Impl>(std::move(base.pimpl)), std::move(recipes), ctl, exec);
+}
+
+std::vector<std::expected<Bytes, err_modifier>>
+Modifier::export_variants(std::vector<ModifierRecipe> recipes, ExecControl ctl, Executor &exec) const {
+    // Non-owning, all tasks are waited for before returning
+    auto futures = submit_variants(std::shared_ptr<const Impl>(std::shared_ptr<const Impl>{}, pimpl.get()),
+                                   std::move(recipes), ctl, exec);
+
+    std::vector<std::expected<Bytes, err_modifier>> res;
+    res.reserve(futures.size());
+    for (auto &fut : futures) { res.push_back(fut.get()); }
+    return res;
+}
+
+// JSON
+std::expected<size_t, err_modifier>
+Modifier::export_json(std::function<void(std::string_view)> const &sink, bool const pretty) {
+    detail::_allocScope allocs("Modifier::export_json");
     if (! pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
-    else { return pimpl->exportResult(opts); }
+    if (pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
+    return pimpl->export_json(sink, pretty);
+}
+std::expected<std::string, err_modifier>
+Modifier::export_json(bool const pretty) {
+    std::string res;
+    auto        exp_size = export_json([&](std::string_view const chunk) { res.append(chunk); }, pretty);
+    if (not exp_size.has_value()) { return std::unexpected(exp_size.error()); }
+    return res;
+}
+
+std::expected<Modifier, err_modifier>
+Modifier::from_json(std::string_view const json, Options const &opts) {
+    detail::_allocScope            allocs("Modifier::from_json");
+    if (! opts.pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    detail::metrics::_latencyScope latency(detail::metrics::histogram::parseLatency_us);
+    detail::metrics::add(detail::metrics::counter::parseBytesIn, json.size());
+
+    // json_builder_extra makes the tree freeable by json_builder_free(), same as otfcc's own trees
+    detail::_traceScope trace_parse("modifier.parseJSON");
+    trace_parse.set_bytesIn(json.size());
+    json_settings settings{};
+    settings.value_extra = json_builder_extra;
+    char            parseErr[json_error_max];
+    json_value_uptr root(json_parse_ex(&settings, json.data(), json.size(), parseErr));
+    trace_parse.end();
+    if (! root) { return std::unexpected(err_modifier::json_invalid); }
+    if (root->type != json_object) { return std::unexpected(err_modifier::unexpectedJSONValueType); }
+
+    json_value *glyf = json_ext::get(*root, "glyf"sv);
+    if (! glyf) { return std::unexpected(err_modifier::missingJSONKey); }
+    if (glyf->type != json_object) { return std::unexpected(err_modifier::unexpectedJSONValueType); }
+
+    // Names are resolved by otfcc's reader and consolidation, references to glyphs missing from 'glyf' are dropped
+    // there (as otfccbuild does). Only the hints are taken out here, so that otfcc doesn't read them at all.
+    if (opts.pimpl->_opts->ignore_hints) {
+        static constexpr std::array<std::string_view, 1> glyphHints{"instructions"sv};
+        for (unsigned int i = 0; i < glyf->u.object.length; ++i) {
+            json_value *glyph = glyf->u.object.values[i].value;
+            if (! glyph || glyph->type != json_object) { continue; }
+            if (auto exp_rem = json_ext::remove_parsedObjectMembers(glyph, glyphHints); not exp_rem.has_value()) {
+                return std::unexpected(exp_rem.error());
+            }
+        }
+        // Same tables as remove_ttfHints() drops, in one pass over the root
+        static constexpr std::array<std::string_view, 4> hintTables{"fpgm"sv, "prep"sv, "cvt_"sv, "gasp"sv};
+        if (auto exp_rem = json_ext::remove_parsedObjectMembers(root.get(), hintTables); not exp_rem.has_value()) {
+            return std::unexpected(exp_rem.error());
+        }
+    }
+
+    detail::_traceScope trace_build("modifier.buildFont");
+    otfcc_IFontBuilder *reader = otfcc_newJsonReader();
+    otfcc_Font_uptr     font(reader->read(root.get(), 0, opts.pimpl.get()->_opts.get()));
+    reader->free(reader);
+    if (! font) { return std::unexpected(err_modifier::json_invalid); }
+    if (font->glyf) { trace_build.set_glyphCount(font->glyf->length); }
+    trace_build.end();
+    root.reset();
+
+    uint64_t const fingerprint = detail::xxh64::hash(std::as_bytes(std::span(json.data(), json.size())));
+    auto impl = std::make_unique<Impl>(std::move(font), fingerprint, opts, Impl::from_font_t{});
+    return Modifier(std::move(impl));
+}
+
+// Snapshots
+std::expected<Bytes, err_modifier>
+Modifier::save_snapshot() {
+    detail::_allocScope allocs("Modifier::save_snapshot");
+    if (! pimpl) { return std::unexpected(err_modifier::unexpectedNullptr); }
+    if (pimpl->_mustDiscard) { return std::unexpected(err_modifier::fontMustBeDiscarded); }
+    return pimpl->save_snapshot();
+}
+
+std::expected<Modifier, err_modifier>
+Modifier::from_snapshot(ByteSpan const snapshot, std::optional<uint64_t> const expectedSourceFingerprint) {
+    if (snapshot.size() < snapshot_fmt::headerSize ||
+        std::memcmp(snapshot.data(), snapshot_fmt::magic, sizeof(snapshot_fmt::magic)) != 0 ||
+        snapshot_fmt::read_le(snapshot, 4, 4) != snapshot_fmt::version) {
+        return std::unexpected(err_modifier::snapshot_invalid);
+    }
+    uint64_t const sourceFingerprint = snapshot_fmt::read_le(snapshot, 8, 8);
+    uint64_t const sfntSize          = snapshot_fmt::read_le(snapshot, 16, 8);
+    if (sfntSize != snapshot.size() - snapshot_fmt::headerSize) {
+        return std::unexpected(err_modifier::snapshot_invalid);
+    }
+    if (expectedSourceFingerprint.has_value() && expectedSourceFingerprint.value() != sourceFingerprint) {
+        return std::unexpected(err_modifier::snapshot_stale);
+    }
+
+    ByteSpan const sfnt = snapshot.subspan(snapshot_fmt::headerSize);
+    if (detail::xxh64::hash(sfnt) != snapshot_fmt::read_le(snapshot, 24, 8)) {
+        return std::unexpected(err_modifier::snapshot_invalid);
+    }
+
+    auto impl = std::make_unique<Impl>(sfnt, sourceFingerprint, Impl::from_snapshot_t{});
+    if (! impl->_font) { return std::unexpected(err_modifier::snapshot_invalid); }
+    return Modifier(std::move(impl));
+}
+std::expected<Modifier, err_modifier>
+Modifier::from_snapshot(std::filesystem::path const &pth, std::optional<uint64_t> const expectedSourceFingerprint) {
+    auto exp_mapped = detail::mapped_file::open(pth);
+    if (not exp_mapped.has_value()) { return std::unexpected(err_modifier::snapshot_invalid); }
+    // The font doesn't reference the data after parsing, the mapping can go right after
+    return from_snapshot(exp_mapped->bytes(), expectedSourceFingerprint);
 }
 
 
@@ -869,6 +2231,11 @@ Converter::max_compressed_size(ByteSpan data, const std::string &extended_metada
 
 std::expected<Bytes, err_converter>
 Converter::encode_Woff2(ByteSpan ttf) {
+    detail::_allocScope            allocs("Converter::encode_Woff2");
+    detail::_traceScope            trace("converter.woff2Encode");
+    detail::metrics::_latencyScope latency(detail::metrics::histogram::woff2EncodeLatency_us);
+    trace.set_bytesIn(ttf.size());
+
     size_t max_size = max_compressed_size(ttf);
     Bytes  output(max_size);
 
@@ -886,11 +2253,28 @@ Converter::encode_Woff2(ByteSpan ttf) {
     if (! ok) { return std::unexpected(err_converter::unknownError); }
 
     output.resize(actual_size);
+    trace.set_bytesOut(output.size());
+
+    detail::metrics::add(detail::metrics::counter::woff2Encodes);
+    detail::metrics::add(detail::metrics::counter::woff2EncodeBytesIn, ttf.size());
+    detail::metrics::add(detail::metrics::counter::woff2EncodeBytesOut, output.size());
+    if (not ttf.empty()) {
+        detail::metrics::observe(detail::metrics::histogram::woff2CompressionRatio_permille,
+                                 output.size() * 1000 / ttf.size());
+    }
     return output;
 }
+std::expected<Bytes, err_converter>
+Converter::encode_Woff2(FontSource const &src) {
+    return encode_Woff2(src.bytes());
+}
 
 std::expected<Bytes, err_converter>
 Converter::decode_Woff2(ByteSpan ttf) {
+    detail::_allocScope allocs("Converter::decode_Woff2");
+    detail::_traceScope trace("converter.woff2Decode");
+    trace.set_bytesIn(ttf.size());
+
     // Redirects and captures stderr
     detail::_stderrCapture err_cap;
 
@@ -907,13 +2291,27 @@ Converter::decode_Woff2(ByteSpan ttf) {
     if (! ok) { return std::unexpected(err_converter::woff2_decompressionFailed); }
 
     output.resize(out.Size());
+    trace.set_bytesOut(output.size());
+    detail::metrics::add(detail::metrics::counter::woff2Decodes);
     return output;
 }
 
+std::future<std::expected<Bytes, err_converter>>
+Converter::encode_Woff2_async(FontSource src, ExecControl ctl, Executor &exec) {
+    return detail::submit_async(exec, [src = std::move(src), ctl = std::move(ctl)]() {
+        if (auto const st = detail::_execCheck(ctl).check()) {
+            return std::expected<Bytes, err_converter>(std::unexpect, detail::to_err<err_converter>(st.value()));
+        }
+        return encode_Woff2(src);
+    });
+}
+
 std::expected<std::string, err_converter>
 Converter::encode_base64(ByteSpan bytes) noexcept {
     try {
-        return base64::encode_into<std::string>(bytes.begin(), bytes.end());
+        std::string res(base64_encodedSize(bytes.size()), '\0');
+        detail::b64::encode(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size(), res.data());
+        return res;
     }
     catch (...) {
         return std::unexpected(err_converter::unknownError);
@@ -921,13 +2319,229 @@ Converter::encode_base64(ByteSpan bytes) noexcept {
 }
 std::expected<Bytes, err_converter>
 Converter::decode_base64(std::string_view base64Encoded) noexcept {
+    Bytes res;
+    if (auto exp_written = decode_base64_append(base64Encoded, res); not exp_written.has_value()) {
+        return std::unexpected(exp_written.error());
+    }
+    return res;
+}
+
+std::expected<size_t, err_converter>
+Converter::encode_base64_into(ByteSpan bytes, std::span<char> out) noexcept {
+    size_t const encSize = base64_encodedSize(bytes.size());
+    if (out.size() < encSize) { return std::unexpected(err_converter::outputBufferTooSmall); }
+
+    detail::b64::encode(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size(), out.data());
+    return encSize;
+}
+std::expected<size_t, err_converter>
+Converter::encode_base64_append(ByteSpan bytes, std::string &out) noexcept {
+    try {
+        size_t const prevSize = out.size();
+        size_t const encSize  = base64_encodedSize(bytes.size());
+
+        // Single growth to the exact final size, the encoder then writes straight into the string's buffer
+        out.resize_and_overwrite(prevSize + encSize, [&](char *buf, size_t bufSize) {
+            detail::b64::encode(reinterpret_cast<const uint8_t *>(bytes.data()), bytes.size(), buf + prevSize);
+            return bufSize;
+        });
+        return encSize;
+    }
+    catch (...) {
+        return std::unexpected(err_converter::unknownError);
+    }
+}
+std::expected<size_t, err_converter>
+Converter::decode_base64_append(std::string_view base64Encoded, Bytes &out) noexcept {
+    if (base64Encoded.size() % 4 != 0) { return std::unexpected(err_converter::base64_dataInvalid); }
+    try {
+        size_t const prevSize = out.size();
+        out.resize(prevSize + (base64Encoded.size() / 4) * 3);
+
+        auto const written = detail::b64::decode(base64Encoded.data(), base64Encoded.size(),
+                                                 reinterpret_cast<uint8_t *>(out.data() + prevSize));
+        if (not written.has_value()) {
+            out.resize(prevSize);
+            return std::unexpected(err_converter::base64_dataInvalid);
+        }
+        out.resize(prevSize + written.value());
+        return written.value();
+    }
+    catch (...) {
+        return std::unexpected(err_converter::unknownError);
+    }
+}
+
+std::expected<std::string, err_converter>
+Converter::encode_dataURI(ByteSpan bytes, std::string_view mimeType) noexcept {
+    static constexpr auto prefix_beg = "data:"sv;
+    static constexpr auto prefix_end = ";base64,"sv;
+    try {
+        std::string res;
+        res.reserve(prefix_beg.size() + mimeType.size() + prefix_end.size() + base64_encodedSize(bytes.size()));
+        res.append(prefix_beg).append(mimeType).append(prefix_end);
+
+        if (auto exp_written = encode_base64_append(bytes, res); not exp_written.has_value()) {
+            return std::unexpected(exp_written.error());
+        }
+        return res;
+    }
+    catch (...) {
+        return std::unexpected(err_converter::unknownError);
+    }
+}
+
+std::expected<Bytes, err_converter>
+Converter::apply_subsetPatch(ByteSpan previous, ByteSpan patch) noexcept {
+    try {
+        auto exp_res = detail::patch::decode(previous, patch);
+        if (not exp_res.has_value()) {
+            return std::unexpected(exp_res.error() == detail::patch::decode_error::baseMismatch
+                                       ? err_converter::patch_baseMismatch
+                                       : err_converter::patch_dataInvalid);
+        }
+        return std::move(exp_res.value());
+    }
+    catch (...) {
+        return std::unexpected(err_converter::unknownError);
+    }
+}
+
+
+// #####################################################################
+// ### Base64Encoder / Base64Decoder implementation ###
+// #####################################################################
+
+std::expected<size_t, err_converter>
+Base64Encoder::feed(ByteSpan chunk, std::span<char> out) noexcept {
+    size_t const total = carryLen_ + chunk.size();
+    size_t const whole = (total / 3) * 3;
+    if (out.size() < (whole / 3) * 4) { return std::unexpected(err_converter::outputBufferTooSmall); }
+
+    size_t written = 0;
+    // Complete the carried over group first
+    if (carryLen_ > 0 && whole > 0) {
+        std::array<std::byte, 3> grp{};
+        size_t const             fromChunk = 3 - carryLen_;
+        std::copy_n(carry_.begin(), carryLen_, grp.begin());
+        std::copy_n(chunk.begin(), fromChunk, grp.begin() + carryLen_);
+        detail::b64::encode(reinterpret_cast<const uint8_t *>(grp.data()), 3, out.data());
+
+        written  += 4;
+        chunk     = chunk.subspan(fromChunk);
+        carryLen_ = 0;
+    }
+
+    size_t const bulk = (chunk.size() / 3) * 3;
+    if (carryLen_ == 0 && bulk > 0) {
+        detail::b64::encode(reinterpret_cast<const uint8_t *>(chunk.data()), bulk, out.data() + written);
+        written += (bulk / 3) * 4;
+        chunk    = chunk.subspan(bulk);
+    }
+
+    // Whatever is left (less than one group) is carried over
+    std::ranges::copy(chunk, carry_.begin() + carryLen_);
+    carryLen_ += chunk.size();
+    return written;
+}
+std::expected<size_t, err_converter>
+Base64Encoder::feed(ByteSpan chunk, std::string &out) noexcept {
     try {
-        return base64::decode_into<Bytes>(base64Encoded);
+        size_t const prevSize = out.size();
+        size_t const maxGrow  = ((carryLen_ + chunk.size()) / 3) * 4;
+
+        std::expected<size_t, err_converter> res;
+        out.resize_and_overwrite(prevSize + maxGrow, [&](char *buf, size_t) {
+            res = feed(chunk, std::span<char>(buf + prevSize, maxGrow));
+            return prevSize + res.value_or(0);
+        });
+        return res;
     }
     catch (...) {
         return std::unexpected(err_converter::unknownError);
     }
 }
 
+std::expected<size_t, err_converter>
+Base64Encoder::finish(std::span<char> out) noexcept {
+    if (carryLen_ == 0) { return 0uz; }
+    if (out.size() < 4) { return std::unexpected(err_converter::outputBufferTooSmall); }
+
+    detail::b64::encode(reinterpret_cast<const uint8_t *>(carry_.data()), carryLen_, out.data());
+    carryLen_ = 0;
+    return 4uz;
+}
+std::expected<size_t, err_converter>
+Base64Encoder::finish(std::string &out) noexcept {
+    try {
+        std::array<char, 4> tail{};
+        auto                exp_written = finish(std::span<char>(tail));
+        if (exp_written.has_value()) { out.append(tail.data(), exp_written.value()); }
+        return exp_written;
+    }
+    catch (...) {
+        return std::unexpected(err_converter::unknownError);
+    }
+}
+
+std::expected<size_t, err_converter>
+Base64Decoder::feed(std::string_view chunk, Bytes &out) noexcept {
+    // Every failure resets the decoder (like finish() does), the stream is lost anyway
+    auto const fail = [&](err_converter const e) -> std::expected<size_t, err_converter> {
+        carryLen_ = 0;
+        padded_   = false;
+        return std::unexpected(e);
+    };
+
+    // Nothing may follow a padded quartet
+    if (padded_ && not chunk.empty()) { return fail(err_converter::base64_dataInvalid); }
+
+    // The decoder itself only accepts padding in the last quartet it is given. Here we additionally make sure that
+    // such quartet is also the last one of the stream (so far)
+    auto const decode = [&](std::string_view quartets, bool const moreToCome) -> std::expected<size_t, err_converter> {
+        if (quartets.back() == '=') {
+            if (moreToCome) { return std::unexpected(err_converter::base64_dataInvalid); }
+            padded_ = true;
+        }
+        return Converter::decode_base64_append(quartets, out);
+    };
+
+    size_t written = 0;
+
+    // Complete the carried over quartet first
+    if (carryLen_ > 0) {
+        size_t const fromChunk = std::min(4 - carryLen_, chunk.size());
+        std::ranges::copy(chunk.substr(0, fromChunk), carry_.begin() + carryLen_);
+        carryLen_ += fromChunk;
+        chunk.remove_prefix(fromChunk);
+
+        if (carryLen_ < 4) { return 0uz; }
+
+        auto exp_res = decode(std::string_view(carry_.data(), 4), not chunk.empty());
+        if (not exp_res.has_value()) { return fail(exp_res.error()); }
+        written   += exp_res.value();
+        carryLen_  = 0;
+    }
+
+    if (size_t const bulk = (chunk.size() / 4) * 4; bulk > 0) {
+        auto exp_res = decode(chunk.substr(0, bulk), bulk != chunk.size());
+        if (not exp_res.has_value()) { return fail(exp_res.error()); }
+        written += exp_res.value();
+        chunk.remove_prefix(bulk);
+    }
+
+    // Less than one quartet left, carried over
+    std::ranges::copy(chunk, carry_.begin());
+    carryLen_ = chunk.size();
+    return written;
+}
+std::expected<size_t, err_converter>
+Base64Decoder::finish(Bytes &) noexcept {
+    bool const incomplete = (carryLen_ != 0);
+    carryLen_             = 0;
+    padded_               = false;
+    if (incomplete) { return std::unexpected(err_converter::base64_dataInvalid); }
+    return 0uz;
+}
 
 } // namespace otfccxx
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+
+namespace otfccxx {
+namespace detail {
+namespace b64 {
+
+// Exact length of padded base64 encoding of 'n' bytes
+constexpr std::size_t
+encoded_size(std::size_t n) noexcept {
+    return ((n + 2) / 3) * 4;
+}
+
+// Encodes 'n' bytes (with '=' padding) into 'dst' which must hold at least encoded_size(n) chars.
+// Uses the widest SIMD variant the running CPU supports (AVX2, SSSE3 or scalar).
+void
+encode(const std::uint8_t *src, std::size_t n, char *dst) noexcept;
+
+// Decodes 'n' chars ('n' must be a multiple of 4, '=' padding allowed only in the last quartet) into 'dst' which must
+// hold at least (n / 4 * 3) bytes. Returns the number of bytes written or std::nullopt on invalid input.
+std::optional<std::size_t>
+decode(const char *src, std::size_t n, std::uint8_t *dst) noexcept;
+
+// Name of the variant picked by the runtime dispatch ("avx2", "ssse3" or "scalar"). Mainly for benchmarks.
+const char *
+active_variant() noexcept;
+
+} // namespace b64
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <otfccxx/otfccxx.hpp>
+
+#include <otfccxx_private/font_source_impl.hpp>
+
+
+namespace otfccxx {
+
+namespace detail {
+namespace covidx {
+
+// Layout (integers little endian, every section starts 8 byte aligned):
+//   header    "OTXCOVIX", u32 version, u32 fontCount, u64 rangeCount, u64 stringBytes, u64 xxh64(all after the header),
+//             u64 reserved
+//   entries   fontCount x {u64 contentHash, u64 fileSize, i64 mtime, u64 firstRange, u32 rangeCount, u32 faceIndex,
+//                          u32 pathOffset, u32 pathLength, u8 group, 7 x u8 reserved}
+//   ranges    rangeCount x {u32 first, u32 last}, sorted per entry
+//   strings   paths, UTF-8
+// 'mtime' is the file_time_type tick count, it's only ever compared for equality.
+constexpr char          magic[8]   = {'O', 'T', 'X', 'C', 'O', 'V', 'I', 'X'};
+constexpr std::uint32_t version    = 1;
+constexpr std::size_t   headerSize = 48;
+constexpr std::size_t   entrySize  = 56;
+constexpr std::size_t   rangeSize  = 8;
+
+struct entry {
+    CoverageFont  font;
+    std::uint64_t contentHash = 0;
+    std::uint64_t fileSize    = 0;
+    std::int64_t  mtime       = 0;
+    std::uint64_t firstRange  = 0;
+    std::uint32_t rangeCount  = 0;
+};
+
+} // namespace covidx
+} // namespace detail
+
+
+class CoverageIndex::Impl {
+public:
+    using entry = detail::covidx::entry;
+
+    // View of the serialized index, points into 'owned' or 'mapped'
+    ByteSpan data;
+
+    Bytes               owned;
+    detail::mapped_file mapped;
+
+    // Decoded and validated on load, the ranges stay in 'data'
+    std::vector<entry> entries;
+
+    CPRange
+    range(entry const &e, std::uint32_t i) const noexcept;
+};
+
+} // namespace otfccxx
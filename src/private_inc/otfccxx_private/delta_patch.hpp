@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace patch {
+
+// Copy/add binary delta, 'target' is rebuilt from pieces of 'base' and literal bytes.
+//
+// Layout (varints are unsigned LEB128, integers little endian):
+//   "OXD1"                                magic
+//   varint baseSize, u64 xxh64(base)      the patch only applies to exactly this base
+//   varint targetSize, u64 xxh64(target)  checked after applying
+//   ops until targetSize bytes are produced:
+//     varint (len << 1)     + 'len' literal bytes   ... add
+//     varint (len << 1 | 1) + zigzag varint delta   ... copy 'len' bytes of base, starting 'delta' bytes after the
+//                                                       end of the previous copy
+constexpr char magic[4] = {'O', 'X', 'D', '1'};
+
+// Shortest match worth a copy op
+constexpr std::size_t minMatch = 12;
+
+Bytes
+encode(ByteSpan base, ByteSpan target);
+
+enum class decode_error {
+    dataInvalid,
+    baseMismatch,
+};
+// Returns the rebuilt target or why it couldn't be rebuilt
+std::expected<Bytes, decode_error>
+decode(ByteSpan base, ByteSpan patch);
+
+} // namespace patch
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <otfccxx_private/machinery_uptr.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+
+// Deep copy of a parsed font, nothing is shared with 'src'. The glyph order isn't copied, consolidation rebuilds it
+// from the glyph names (which is what otfcc does for fonts built in memory). Returns nullptr when out of memory.
+otfcc_Font_uptr
+copy_font(otfcc_Font const &src);
+// Deep copy of one glyph, to be released with glyf_iGlyph.free(). nullptr for nullptr or when out of memory.
+glyf_GlyphPtr
+copy_glyph(const glyf_Glyph *src);
+
+} // namespace detail
+} // namespace otfccxx
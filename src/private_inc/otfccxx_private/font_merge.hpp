@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+
+#include <otfcc/otfcc_api.h>
+
+
+namespace otfccxx {
+namespace detail {
+namespace font_merge {
+
+enum class error {
+    missingGlyph,   // A reference points past the end of 'glyf'
+    handleNotIndex, // A reference that isn't resolved to a glyph index
+    cffOutlines,    // CFF glyphs depend on the private dicts of their own font
+    outOfMemory,
+};
+
+// Appends copies of the glyphs 'other' maps the codepoints 'base' lacks to (plus their components) to 'base' and maps
+// those codepoints to them. Both fonts must be consolidated and use the same unitsPerEm. Glyphs whose names 'base'
+// already uses are renamed with a '.m' suffix, their instructions are dropped as they were written for the other
+// font's 'fpgm' and 'cvt '. Only glyphs and 'cmap' are merged, the layout tables of 'other' are not. Drops the glyph
+// order of 'base', consolidate it afterwards. 'base' is left as it was on failure. Returns the number of glyphs added.
+std::expected<std::size_t, error>
+append(otfcc_Font &base, otfcc_Font const &other);
+
+} // namespace font_merge
+} // namespace detail
+} // namespace otfccxx
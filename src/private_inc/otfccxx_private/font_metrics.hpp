@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+
+#include <otfcc/otfcc_api.h>
+
+
+namespace otfccxx {
+namespace detail {
+namespace font_metrics {
+
+enum class error {
+    missingGlyph,    // A reference points past the end of 'glyf'
+    handleNotIndex,  // A reference that isn't resolved to a glyph index
+    cyclicReference, // A glyph references itself, directly or not
+};
+
+// Recomputes the bounds and point/contour counts of every glyph (glyf_Glyph::stat) and the font wide values derived
+// from them: the 'head' bounding box, 'hhea' advanceWidthMax/minLeftSideBearing/minRightSideBearing/xMaxExtent and the
+// glyph related 'maxp' maxima. Outlines are measured in parallel chunks ('threadCount', 0 = hardware concurrency),
+// composites then combine the bounds of their components. Tables the font doesn't have are skipped.
+// Returns the number of glyphs.
+std::expected<std::size_t, error>
+recompute(otfcc_Font &font, std::size_t threadCount = 0);
+
+// OS/2 usMaxContext of the given layout tables (either may be null): the longest glyph sequence a lookup matches on,
+// ie. ligature components, input plus lookahead of contextual rules and 2 for pair positioning
+std::uint16_t
+max_context(table_OTL const *gsub, table_OTL const *gpos) noexcept;
+
+} // namespace font_metrics
+} // namespace detail
+} // namespace otfccxx
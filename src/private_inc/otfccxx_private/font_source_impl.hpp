@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+
+namespace detail {
+
+// Read-only memory mapping of a whole file
+class mapped_file {
+public:
+    mapped_file() = default;
+    ~mapped_file();
+
+    mapped_file(const mapped_file &) = delete;
+    mapped_file &
+    operator=(const mapped_file &) = delete;
+    mapped_file(mapped_file &&other) noexcept;
+    mapped_file &
+    operator=(mapped_file &&other) noexcept;
+
+    static std::expected<mapped_file, err_fontSource>
+    open(std::filesystem::path const &pth);
+
+    ByteSpan
+    bytes() const noexcept {
+        return ByteSpan(static_cast<const std::byte *>(addr_), size_);
+    }
+
+private:
+    void
+    reset() noexcept;
+
+    void  *addr_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void *mapping_ = nullptr;
+#endif
+};
+
+} // namespace detail
+
+
+class FontSource::Impl {
+public:
+    // View of the font data, points into 'owned', 'mapped' or into caller owned memory
+    ByteSpan data;
+
+    Bytes               owned;
+    detail::mapped_file mapped;
+
+    // One table directory per face (one face for plain SFNT, numFonts for TTC)
+    std::vector<std::vector<TableRecord>> faces;
+
+    uint64_t
+    get_fingerprint() const;
+
+private:
+    mutable std::once_flag fingerprint_once;
+    mutable uint64_t       fingerprint = 0;
+};
+
+} // namespace otfccxx
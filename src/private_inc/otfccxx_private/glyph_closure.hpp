@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <expected>
+#include <span>
+#include <vector>
+
+#include <otfcc/otfcc_api.h>
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace glyph_closure {
+
+enum class error {
+    missingGlyph,   // A reference points past the end of 'glyf'
+    handleNotIndex, // A reference that isn't resolved to a glyph index
+};
+
+// Glyphs (by index into 'glyf') reachable from the codepoints in 'cps': .notdef, the glyphs 'cmap' maps them to, and
+// then repeatedly everything referenced by a reachable composite, substituted for reachable glyphs by a GSUB lookup or
+// layered onto a reachable glyph by COLR. GSUB is evaluated like harfbuzz's closure without contexts: every lookup of
+// every feature counts and contextual lookups only through the lookups they call, so the result may be larger than
+// strictly needed but never misses a glyph a shaper could produce. 'followTables' false stops at cmap and composites.
+// The font must be consolidated.
+std::expected<std::vector<bool>, error>
+reachable(otfcc_Font const &font, std::span<const CPRange> cps, bool followTables = true);
+
+// Deletes the glyphs not in 'keep' from 'glyf' along with the 'cmap' entries outside of 'cps' or mapping to a deleted
+// glyph, and drops the glyph order. Tables otfcc keeps as glyph index addressed blobs (LTSH, SVG, the TSI* sources of
+// VTT) are deleted. Consolidating the font afterwards renumbers the rest in order and removes the references to deleted
+// glyphs from the OTL tables. Returns the number of glyphs left.
+std::size_t
+retain(otfcc_Font &font, std::vector<bool> const &keep, std::span<const CPRange> cps);
+
+} // namespace glyph_closure
+} // namespace detail
+} // namespace otfccxx
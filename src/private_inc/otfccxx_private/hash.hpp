@@ -0,0 +1,102 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+
+namespace otfccxx {
+namespace detail {
+
+// XXH64 (Yann Collet's xxHash, 64 bit variant). Used for content fingerprints of font data.
+class xxh64 {
+public:
+    static std::uint64_t
+    hash(std::span<const std::byte> data, std::uint64_t const seed = 0) noexcept {
+        const std::byte *p   = data.data();
+        const std::byte *end = p + data.size();
+        std::uint64_t    h;
+
+        if (data.size() >= 32) {
+            std::uint64_t v1 = seed + P1 + P2;
+            std::uint64_t v2 = seed + P2;
+            std::uint64_t v3 = seed;
+            std::uint64_t v4 = seed - P1;
+
+            for (const std::byte *limit = end - 32; p <= limit; p += 32) {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+            }
+
+            h = std::rotl(v1, 1) + std::rotl(v2, 7) + std::rotl(v3, 12) + std::rotl(v4, 18);
+            h = merge_round(h, v1);
+            h = merge_round(h, v2);
+            h = merge_round(h, v3);
+            h = merge_round(h, v4);
+        }
+        else { h = seed + P5; }
+
+        h += static_cast<std::uint64_t>(data.size());
+
+        for (; p + 8 <= end; p += 8) {
+            h ^= round(0, read64(p));
+            h  = std::rotl(h, 27) * P1 + P4;
+        }
+        if (p + 4 <= end) {
+            h ^= static_cast<std::uint64_t>(read32(p)) * P1;
+            h  = std::rotl(h, 23) * P2 + P3;
+            p += 4;
+        }
+        for (; p < end; ++p) {
+            h ^= static_cast<std::uint64_t>(std::to_integer<std::uint8_t>(*p)) * P5;
+            h  = std::rotl(h, 11) * P1;
+        }
+
+        h ^= h >> 33;
+        h *= P2;
+        h ^= h >> 29;
+        h *= P3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static constexpr std::uint64_t P1 = 0x9E3779B185EBCA87ull;
+    static constexpr std::uint64_t P2 = 0xC2B2AE3D27D4EB4Full;
+    static constexpr std::uint64_t P3 = 0x165667B19E3779F9ull;
+    static constexpr std::uint64_t P4 = 0x85EBCA77C2B2AE63ull;
+    static constexpr std::uint64_t P5 = 0x27D4EB2F165667C5ull;
+
+    static std::uint64_t
+    read64(const std::byte *p) noexcept {
+        std::uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) { v = std::byteswap(v); }
+        return v;
+    }
+    static std::uint32_t
+    read32(const std::byte *p) noexcept {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        if constexpr (std::endian::native == std::endian::big) { v = std::byteswap(v); }
+        return v;
+    }
+    static std::uint64_t
+    round(std::uint64_t acc, std::uint64_t const input) noexcept {
+        acc += input * P2;
+        acc  = std::rotl(acc, 31);
+        return acc * P1;
+    }
+    static std::uint64_t
+    merge_round(std::uint64_t acc, std::uint64_t const val) noexcept {
+        acc ^= round(0, val);
+        return acc * P1 + P4;
+    }
+};
+
+} // namespace detail
+} // namespace otfccxx
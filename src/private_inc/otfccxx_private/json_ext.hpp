@@ -1,5 +1,10 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <string_view>
+
 #include <otfccxx/otfccxx.hpp>
 #include <otfccxx_private/machinery_uptr.hpp>
 
@@ -106,11 +111,8 @@ remove_objectMemberByName(json_value *obj, std::string_view key) {
 
     if (! removed) { return false; }
 
-    // Shrink array
+    // The array isn't shrunk, see remove_objectMembers()
     obj->u.object.length = write_i;
-    obj->u.object.values =
-        (decltype(obj->u.object.values))std::realloc(obj->u.object.values, write_i * sizeof(*obj->u.object.values));
-
     return true;
 }
 
@@ -139,13 +141,9 @@ remove_objectMembers(json_value *obj, P const pred) {
         ++write_i;
     }
 
-    // Shrink array if we did some removal. It is not an error to remove nothing
-    if (write_i != obj->u.object.length) {
-        obj->u.object.length = write_i;
-        obj->u.object.values =
-            (decltype(obj->u.object.values))std::realloc(obj->u.object.values, write_i * sizeof(*obj->u.object.values));
-    }
-
+    // It is not an error to remove nothing. The array keeps its size, a realloc per call dominated batch edits of
+    // large objects (and json-parser keeps the member names in the same allocation, right after the array).
+    obj->u.object.length = write_i;
     return removed;
 }
 
@@ -159,7 +157,7 @@ requires std::predicate<P, const json_object_entry &> && std::invocable<EXTR_FN,
 remove_objectMembers(json_value *obj, P const pred, EXTR_FN const extr_fn)
     -> std::expected<std::vector<std::invoke_result_t<EXTR_FN, const json_object_entry &>>, err_modifier> {
 
-    if (! obj) { return false; }
+    if (! obj) { return {}; }
     if (obj->type != json_object) { return std::unexpected(err_modifier::unexpectedJSONValueType); }
 
     size_t                                                                write_i = 0;
@@ -168,7 +166,7 @@ remove_objectMembers(json_value *obj, P const pred, EXTR_FN const extr_fn)
     for (size_t i = 0; i < obj->u.object.length; ++i) {
         auto &entry = obj->u.object.values[i];
         if (pred(entry)) {
-            contentFromRemoved.push_back(EXTR_FN(entry));
+            contentFromRemoved.push_back(extr_fn(entry));
 
             // Free the value for the removed member
             free_jsonValue(entry.value);
@@ -180,16 +178,35 @@ remove_objectMembers(json_value *obj, P const pred, EXTR_FN const extr_fn)
         ++write_i;
     }
 
-    // Shrink array if we did some removal. It is not an error to remove nothing
-    if (write_i != obj->u.object.length) {
-        obj->u.object.length = write_i;
-        obj->u.object.values =
-            (decltype(obj->u.object.values))std::realloc(obj->u.object.values, write_i * sizeof(*obj->u.object.values));
-    }
-
+    obj->u.object.length = write_i;
     return contentFromRemoved;
 }
 
+// Batched removal from a tree made by json_parse_ex() (with json_builder_extra), all members named in 'keys' go in one
+// compaction pass. json-parser keeps the member names inside the array's allocation, so only the values are freed.
+// Returns the number of removed members.
+[[maybe_unused]] static inline std::expected<size_t, err_modifier>
+remove_parsedObjectMembers(json_value *obj, std::span<const std::string_view> const keys) {
+    if (! obj) { return 0uz; }
+    if (obj->type != json_object) { return std::unexpected(err_modifier::unexpectedJSONValueType); }
+
+    size_t write_i = 0;
+    size_t removed = 0uz;
+    for (size_t i = 0; i < obj->u.object.length; ++i) {
+        auto                  &entry = obj->u.object.values[i];
+        std::string_view const name(entry.name, entry.name_length);
+        if (std::ranges::find(keys, name) != keys.end()) {
+            json_builder_free(entry.value);
+            removed++;
+            continue;
+        }
+        if (write_i != i) { obj->u.object.values[write_i] = entry; }
+        ++write_i;
+    }
+    obj->u.object.length = write_i;
+    return removed;
+}
+
 // Get methods ... obtain some json_value* in the tree by some logic
 [[maybe_unused]]
 static inline std::expected<json_value *, err_modifier>
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+#include <otfccxx/otfccxx.hpp>
+#include <otfccxx_private/machinery_uptr.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace json_stream {
+
+// Bytes handed to the sink at once (the last chunk is usually shorter)
+constexpr std::size_t chunkSize = 64 * 1024;
+
+// Serializes 'root' in one depth first pass, the text goes to 'sink' chunk by chunk and never exists as a whole.
+// (json-builder measures the entire tree first and then writes it into a single allocation.) Doubles get the shortest
+// form that reads back to the same value, non-finite ones become null. 'pretty' indents by 2 spaces.
+// Returns the number of bytes written.
+std::size_t
+write(json_value const &root, bool pretty, std::function<void(std::string_view)> const &sink);
+
+} // namespace json_stream
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <string_view>
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+
+#ifdef OTFCCXX_ALLOC_ACCOUNTING
+// Attributes the calling thread's allocations during its lifetime to one public API call (outermost scope only)
+class _allocScope {
+public:
+    explicit _allocScope(std::string_view const call) noexcept;
+    ~_allocScope();
+
+    _allocScope(const _allocScope &) = delete;
+    _allocScope &
+    operator=(const _allocScope &) = delete;
+
+private:
+    std::string_view call_;
+    AllocStats       start_;
+    bool             outermost_;
+};
+#else
+class _allocScope {
+public:
+    explicit constexpr _allocScope(std::string_view const) noexcept {}
+};
+#endif
+
+} // namespace detail
+} // namespace otfccxx
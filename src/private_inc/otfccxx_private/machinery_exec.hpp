@@ -0,0 +1,69 @@
+#pragma once
+
+#include <chrono>
+#include <exception>
+#include <future>
+#include <optional>
+#include <type_traits>
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+
+enum class exec_stop {
+    cancelled,
+    deadlineExceeded,
+};
+
+// Checkpoint of one call, the default one never stops. Doesn't own the ExecControl.
+class _execCheck {
+public:
+    _execCheck() noexcept = default;
+    explicit _execCheck(ExecControl const &ctl) noexcept : ctl_(&ctl) {}
+
+    // std::nullopt means go on
+    std::optional<exec_stop>
+    check() const noexcept {
+        if (not ctl_) { return std::nullopt; }
+        if (ctl_->stopToken.stop_requested()) { return exec_stop::cancelled; }
+        if (ctl_->deadline != std::chrono::steady_clock::time_point::max() &&
+            std::chrono::steady_clock::now() >= ctl_->deadline) {
+            return exec_stop::deadlineExceeded;
+        }
+        return std::nullopt;
+    }
+
+private:
+    ExecControl const *ctl_ = nullptr;
+};
+
+// Maps to the 'cancelled' / 'deadlineExceeded' value of any of the public error enums
+template <typename E>
+constexpr E
+to_err(exec_stop const st) noexcept {
+    return st == exec_stop::cancelled ? E::cancelled : E::deadlineExceeded;
+}
+
+// Runs 'fn' on 'exec', its result (or exception) ends up in the returned future
+template <typename F>
+std::future<std::invoke_result_t<F &>>
+submit_async(Executor &exec, F &&fn) {
+    using res_t = std::invoke_result_t<F &>;
+
+    std::promise<res_t> prom;
+    auto                res = prom.get_future();
+    exec.submit([prom = std::move(prom), fn = std::forward<F>(fn)]() mutable {
+        try {
+            prom.set_value(fn());
+        }
+        catch (...) {
+            prom.set_exception(std::current_exception());
+        }
+    });
+    return res;
+}
+
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace otfccxx {
+namespace detail {
+namespace metrics {
+
+// The names and help texts live in metrics.cpp, keep the order in sync
+enum class counter : size_t {
+    subsetsExecuted = 0,
+    subsetsFailed,
+    facesTouched,
+    subsetBytesOut,
+    modifiersParsed,
+    parseBytesIn,
+    exportsCompleted,
+    exportBytesOut,
+    woff2Encodes,
+    woff2EncodeBytesIn,
+    woff2EncodeBytesOut,
+    woff2Decodes,
+    deltaBytesSaved,
+    lazyFaceLoads,
+    modifiersCloned,
+    _count
+};
+enum class histogram : size_t {
+    facesPerSubset = 0,
+    subsetLatency_us,
+    parseLatency_us,
+    exportLatency_us,
+    woff2EncodeLatency_us,
+    woff2CompressionRatio_permille,
+    _count
+};
+
+// Both only touch the calling thread's shard (relaxed atomics, no locks)
+void
+add(counter c, uint64_t v = 1) noexcept;
+void
+observe(histogram h, uint64_t v) noexcept;
+
+// Observes the lifetime of the scope in microseconds
+class _latencyScope {
+public:
+    explicit _latencyScope(histogram const h) noexcept : h_(h), start_(std::chrono::steady_clock::now()) {}
+    ~_latencyScope() {
+        auto const elapsed = std::chrono::steady_clock::now() - start_;
+        observe(h_, std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
+
+    _latencyScope(const _latencyScope &) = delete;
+    _latencyScope &
+    operator=(const _latencyScope &) = delete;
+
+private:
+    histogram                             h_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace metrics
+} // namespace detail
+} // namespace otfccxx
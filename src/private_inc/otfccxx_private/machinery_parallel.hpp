@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+namespace otfccxx {
+namespace detail {
+
+// Runs 'fn' when the scope ends, however it ends. For the state a parallel section takes out of a shared object, which
+// has to be put back when a worker throws as well.
+template <typename F>
+class _scopeExit {
+public:
+    explicit _scopeExit(F fn) noexcept : fn_(std::move(fn)) {}
+    ~_scopeExit() { fn_(); }
+
+    _scopeExit(const _scopeExit &) = delete;
+    _scopeExit &
+    operator=(const _scopeExit &) = delete;
+
+private:
+    F fn_;
+};
+
+// Calls fn(begin, end) for consecutive chunks of [0, count), 'grain' items each (the last one may be shorter). Chunks
+// are handed out to up to 'threadCount' threads (0 = hardware concurrency), the calling thread being one of them.
+// Runs on its own threads and not on an Executor, the callers may themselves be running on an Executor's worker.
+// An exception thrown by 'fn' stops the handing out of chunks, the first one is rethrown on the calling thread once all
+// the threads are done.
+template <typename F>
+void
+parallel_for(std::size_t const count, std::size_t grain, F const &fn, std::size_t threadCount = 0) {
+    if (count == 0) { return; }
+    grain = std::max<std::size_t>(grain, 1);
+
+    std::size_t const chunks = (count + grain - 1) / grain;
+    if (threadCount == 0) { threadCount = std::max(1u, std::thread::hardware_concurrency()); }
+    threadCount = std::min(threadCount, chunks);
+
+    std::atomic<std::size_t> next{0};
+    std::exception_ptr       failure;
+    std::mutex               failureMtx;
+    auto const               worker = [&]() {
+        try {
+            for (std::size_t c = next.fetch_add(1, std::memory_order_relaxed); c < chunks;
+                 c             = next.fetch_add(1, std::memory_order_relaxed)) {
+                fn(c * grain, std::min(count, (c + 1) * grain));
+            }
+        }
+        catch (...) {
+            next.store(chunks, std::memory_order_relaxed);
+            std::scoped_lock lock(failureMtx);
+            if (! failure) { failure = std::current_exception(); }
+        }
+    };
+
+    std::vector<std::jthread> pool;
+    pool.reserve(threadCount - 1);
+    for (std::size_t i = 1; i < threadCount; ++i) { pool.emplace_back(worker); }
+    worker();
+
+    pool.clear(); // Joins
+    if (failure) { std::rethrow_exception(failure); }
+}
+
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+
+// Defined in trace.cpp
+extern std::atomic<TraceSink *> g_traceSink;
+
+// Times one stage and reports it to the installed sink when the scope ends (or on 'end()').
+// Does nothing but one load and a branch when no sink is installed, the setters only write to a local.
+class _traceScope {
+public:
+    explicit _traceScope(std::string_view const stage) noexcept
+        : sink_(g_traceSink.load(std::memory_order_acquire)) {
+        if (sink_) [[unlikely]] {
+            ev_.stage = stage;
+            ev_.start = std::chrono::steady_clock::now();
+        }
+    }
+    ~_traceScope() { end(); }
+
+    _traceScope(const _traceScope &) = delete;
+    _traceScope &
+    operator=(const _traceScope &) = delete;
+
+    // Use to skip computing expensive figures (eg. glyph counts) when nobody listens
+    bool
+    active() const noexcept {
+        return sink_ != nullptr;
+    }
+
+    void
+    set_bytesIn(uint64_t const v) noexcept {
+        ev_.bytesIn = v;
+    }
+    void
+    set_bytesOut(uint64_t const v) noexcept {
+        ev_.bytesOut = v;
+    }
+    void
+    set_glyphCount(uint64_t const v) noexcept {
+        ev_.glyphCount = v;
+    }
+
+    void
+    end() noexcept {
+        if (sink_) [[unlikely]] { report(); }
+    }
+
+private:
+    void
+    report() noexcept;
+
+    TraceSink *sink_;
+    TraceEvent ev_{};
+};
+
+} // namespace detail
+} // namespace otfccxx
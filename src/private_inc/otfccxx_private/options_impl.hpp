@@ -0,0 +1,28 @@
+#pragma once
+
+#include <otfccxx/otfccxx.hpp>
+#include <otfccxx_private/machinery_uptr.hpp>
+
+
+namespace otfccxx {
+
+class Options::Impl {
+    friend class Modifier;
+    friend class FontSynthesizer;
+
+public:
+    Impl() : _opts(otfcc_newOptions()) {}
+    Impl(uint8_t const optLevel, bool const removeTTFhints) : _opts(otfcc_newOptions()) {
+        otfcc_Options_optimizeTo(_opts.get(), optLevel);
+        _opts->logger = otfcc_newLogger(otfcc_newStdErrTarget());
+        _opts->logger->indent(_opts->logger, "[missing]");
+        _opts->decimal_cmap = true;
+        _opts->ignore_hints = removeTTFhints;
+    }
+
+private:
+    otfcc_opt_uptr _opts;
+    size_t         _threadCount = 1;
+};
+
+} // namespace otfccxx
@@ -17,6 +17,7 @@ enum class otfcc_glyfTable_nameMapping : uint32_t {
     hmtx = 0x686D7478, // 'hmtx'
     vmtx = 0x766D7478, // 'vmtx'
     post = 0x706F7374, // 'post'
+    hdmx = 0x68646D78, // 'hdmx'
 
     vhea = 0x76686561, // 'vhea'
     fpgm = 0x6670676D, // 'fpgm'
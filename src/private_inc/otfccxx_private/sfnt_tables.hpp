@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace sfnt {
+
+constexpr std::uint32_t
+tag(char const (&s)[5]) noexcept {
+    return (std::uint32_t(std::uint8_t(s[0])) << 24) | (std::uint32_t(std::uint8_t(s[1])) << 16) |
+           (std::uint32_t(std::uint8_t(s[2])) << 8) | std::uint32_t(std::uint8_t(s[3]));
+}
+
+// One table of a font, 'data' is owned by the caller
+struct table {
+    std::uint32_t tag = 0;
+    ByteSpan      data;
+};
+
+struct font {
+    std::uint32_t      sfntVersion = 0;
+    std::vector<table> tables;
+};
+
+// Table directory of a single (non collection) font, views into 'data'. std::nullopt if it isn't one or a table lies
+// outside of 'data'.
+std::optional<font>
+split(ByteSpan data);
+
+// Writes a font with the tables sorted by tag, each 4 byte aligned, with fresh table checksums and
+// head.checkSumAdjustment. The first table of a tag wins.
+Bytes
+assemble(font const &fnt);
+
+} // namespace sfnt
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <otfcc/otfcc_api.h>
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace table_profile {
+
+// The tag as it appears in a font file, otfcc's spellings of 'OS/2', 'cvt ', 'CFF ' and 'SVG ' are translated
+std::uint32_t
+sfnt_tag(std::uint32_t tag) noexcept;
+
+// The tags of 'present' (as in a font file) that 'profile' drops
+std::vector<std::uint32_t>
+dropped(TableProfile const &profile, std::span<const std::uint32_t> present);
+
+// Whether 'profile' drops any of the tables glyph instructions depend on ('fpgm', 'prep', 'cvt ')
+bool
+drops_hinting(TableProfile const &profile) noexcept;
+
+// Deletes the tables of 'font' that 'profile' drops and the 'name' records outside of its name IDs
+void
+apply(otfcc_Font &font, TableProfile const &profile);
+
+} // namespace table_profile
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+
+namespace otfccxx {
+namespace detail {
+namespace utf {
+
+// One bit per unicode codepoint, decoded text is deduplicated into it
+constexpr std::size_t bitmapWords = 0x110000 / 64;
+
+// Incremental validating decoders, the text may be split into chunks anywhere (even inside a sequence).
+// Each decoded codepoint sets its bit in 'bitmap' (which must be 'bitmapWords' long). A byte order mark at the very
+// beginning of the text is skipped.
+// feed() returns false on invalid input, finish() additionally fails when the text ends inside a sequence. Both
+// leave the decoder ready for the next text.
+// Runs of ASCII (UTF-8) or non-surrogate code units (UTF-16) are found, and blocks made only of 2 or 3 byte UTF-8
+// sequences are validated and decoded, using the widest SIMD variant the running CPU supports (AVX2, SSSE3, SSE2 or
+// scalar, SSE2 decodes 2 byte sequences only). 4 byte sequences, surrogate pairs and the bitmap writes are scalar.
+class utf8_decoder {
+public:
+    bool
+    feed(const std::uint8_t *src, std::size_t n, std::uint64_t *bitmap) noexcept;
+    bool
+    finish() noexcept;
+    void
+    reset() noexcept;
+
+private:
+    void
+    emit(std::uint32_t cp, std::uint64_t *bitmap) noexcept;
+
+    std::array<std::uint8_t, 4> carry_{};
+    std::size_t                 carryLen_ = 0;
+    bool                        atStart_  = true;
+};
+
+// Code units are in native byte order
+class utf16_decoder {
+public:
+    bool
+    feed(const char16_t *src, std::size_t n, std::uint64_t *bitmap) noexcept;
+    bool
+    finish() noexcept;
+    void
+    reset() noexcept;
+
+private:
+    void
+    emit(std::uint32_t cp, std::uint64_t *bitmap) noexcept;
+
+    char16_t pendingHigh_ = 0;
+    bool     atStart_     = true;
+};
+
+// Name of the variant picked by the runtime dispatch ("avx2", "ssse3", "sse2" or "scalar"). Mainly for benchmarks.
+const char *
+active_variant() noexcept;
+
+} // namespace utf
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,119 @@
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include <otfccxx_private/sfnt_tables.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace sfnt {
+
+namespace {
+
+constexpr std::size_t headerSize = 12;
+constexpr std::size_t recordSize = 16;
+
+// head.checkSumAdjustment
+constexpr std::size_t   checkSumAdjustmentOffset = 8;
+constexpr std::uint32_t checkSumMagic            = 0xB1B0AFBA;
+
+std::uint32_t
+read_be(ByteSpan const data, std::size_t const pos, std::size_t const len) noexcept {
+    std::uint32_t res = 0;
+    for (std::size_t i = 0; i < len; ++i) { res = (res << 8) | std::to_integer<std::uint32_t>(data[pos + i]); }
+    return res;
+}
+void
+write_be(Bytes &out, std::size_t const pos, std::uint32_t const v, std::size_t const len) noexcept {
+    for (std::size_t i = 0; i < len; ++i) { out[pos + i] = static_cast<std::byte>(v >> (8 * (len - 1 - i))); }
+}
+
+// Sum of big endian uint32s, the data is zero padded to a multiple of 4
+std::uint32_t
+checksum(ByteSpan const data) noexcept {
+    std::uint32_t     sum  = 0;
+    std::size_t const full = data.size() & ~std::size_t{3};
+    for (std::size_t i = 0; i < full; i += 4) { sum += read_be(data, i, 4); }
+    if (full != data.size()) {
+        std::uint32_t last = 0;
+        for (std::size_t i = full; i < full + 4; ++i) {
+            last = (last << 8) | (i < data.size() ? std::to_integer<std::uint32_t>(data[i]) : 0u);
+        }
+        sum += last;
+    }
+    return sum;
+}
+
+} // namespace
+
+
+std::optional<font>
+split(ByteSpan const data) {
+    if (data.size() < headerSize) { return std::nullopt; }
+    font res;
+    res.sfntVersion              = read_be(data, 0, 4);
+    std::size_t const tableCount = read_be(data, 4, 2);
+    if (res.sfntVersion == tag("ttcf") || data.size() < headerSize + tableCount * recordSize) { return std::nullopt; }
+
+    res.tables.reserve(tableCount);
+    for (std::size_t i = 0; i < tableCount; ++i) {
+        std::size_t const   rec    = headerSize + i * recordSize;
+        std::uint64_t const offset = read_be(data, rec + 8, 4);
+        std::uint64_t const length = read_be(data, rec + 12, 4);
+        if (offset + length > data.size()) { return std::nullopt; }
+        res.tables.push_back(table{read_be(data, rec, 4), data.subspan(offset, length)});
+    }
+    return res;
+}
+
+Bytes
+assemble(font const &fnt) {
+    std::vector<table> tables = fnt.tables;
+    std::ranges::stable_sort(tables, {}, &table::tag);
+    auto const dupes = std::ranges::unique(tables, {}, &table::tag);
+    tables.erase(dupes.begin(), dupes.end());
+
+    std::size_t const tableCount = tables.size();
+    std::size_t       total      = headerSize + tableCount * recordSize;
+    for (auto const &t : tables) { total += (t.data.size() + 3) & ~std::size_t{3}; }
+    Bytes res(total, std::byte{0});
+
+    // Header, the search fields are derived from the largest power of 2 <= tableCount
+    std::uint32_t const entrySelector = tableCount ? std::bit_width(tableCount) - 1 : 0;
+    std::uint32_t const searchRange   = tableCount ? (1u << entrySelector) * recordSize : 0;
+    write_be(res, 0, fnt.sfntVersion, 4);
+    write_be(res, 4, static_cast<std::uint32_t>(tableCount), 2);
+    write_be(res, 6, searchRange, 2);
+    write_be(res, 8, entrySelector, 2);
+    write_be(res, 10, static_cast<std::uint32_t>(tableCount * recordSize - searchRange), 2);
+
+    std::size_t offset  = headerSize + tableCount * recordSize;
+    std::size_t headPos = 0;
+    bool        hasHead = false;
+    for (std::size_t i = 0; i < tableCount; ++i) {
+        table const &t = tables[i];
+        if (not t.data.empty()) { std::memcpy(res.data() + offset, t.data.data(), t.data.size()); }
+
+        ByteSpan const written(res.data() + offset, t.data.size());
+        if (t.tag == tag("head") && t.data.size() >= checkSumAdjustmentOffset + 4) {
+            write_be(res, offset + checkSumAdjustmentOffset, 0, 4);
+            headPos = offset;
+            hasHead = true;
+        }
+
+        std::size_t const rec = headerSize + i * recordSize;
+        write_be(res, rec, t.tag, 4);
+        write_be(res, rec + 4, checksum(written), 4);
+        write_be(res, rec + 8, static_cast<std::uint32_t>(offset), 4);
+        write_be(res, rec + 12, static_cast<std::uint32_t>(t.data.size()), 4);
+        offset += (t.data.size() + 3) & ~std::size_t{3};
+    }
+
+    if (hasHead) { write_be(res, headPos + checkSumAdjustmentOffset, checkSumMagic - checksum(res), 4); }
+    return res;
+}
+
+} // namespace sfnt
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <utility>
+
+#include <otfccxx_private/otfcc_enum.hpp>
+#include <otfccxx_private/sfnt_tables.hpp>
+#include <otfccxx_private/table_profile.hpp>
+
+
+namespace otfccxx {
+namespace detail {
+namespace table_profile {
+
+namespace {
+
+using otfcc_tag = otfcc_glyfTable_nameMapping;
+
+constexpr std::uint32_t
+u(otfcc_tag const tag) noexcept {
+    return std::to_underlying(tag);
+}
+
+// Every table otfcc keeps in an otfcc_Font
+constexpr otfcc_tag otfccTables[] = {
+    otfcc_tag::head, otfcc_tag::hhea, otfcc_tag::maxp, otfcc_tag::OS_2, otfcc_tag::name, otfcc_tag::meta,
+    otfcc_tag::hmtx, otfcc_tag::vmtx, otfcc_tag::post, otfcc_tag::hdmx, otfcc_tag::vhea, otfcc_tag::fpgm,
+    otfcc_tag::prep, otfcc_tag::cvt,  otfcc_tag::gasp, otfcc_tag::CFF,  otfcc_tag::glyf, otfcc_tag::cmap,
+    otfcc_tag::LTSH, otfcc_tag::GSUB, otfcc_tag::GPOS, otfcc_tag::GDEF, otfcc_tag::BASE, otfcc_tag::VORG,
+    otfcc_tag::CPAL, otfcc_tag::COLR, otfcc_tag::SVG,  otfcc_tag::TSI0, otfcc_tag::TSI1, otfcc_tag::TSI2,
+    otfcc_tag::TSI3, otfcc_tag::TSI5,
+};
+
+// Without these the font doesn't load anywhere
+constexpr std::uint32_t requiredTables[] = {
+    sfnt::tag("head"), sfnt::tag("hhea"), sfnt::tag("maxp"), sfnt::tag("OS/2"), sfnt::tag("hmtx"), sfnt::tag("post"),
+    sfnt::tag("cmap"), sfnt::tag("name"), sfnt::tag("glyf"), sfnt::tag("loca"), sfnt::tag("CFF "), sfnt::tag("CFF2"),
+};
+
+bool
+required(std::uint32_t const sfntTag) noexcept {
+    return std::ranges::find(requiredTables, sfntTag) != std::ranges::end(requiredTables);
+}
+
+} // namespace
+
+
+std::uint32_t
+sfnt_tag(std::uint32_t const tag) noexcept {
+    if (tag == u(otfcc_tag::OS_2)) { return sfnt::tag("OS/2"); }
+    if (tag == u(otfcc_tag::cvt)) { return sfnt::tag("cvt "); }
+    if (tag == u(otfcc_tag::CFF)) { return sfnt::tag("CFF "); }
+    if (tag == sfnt::tag("SVG_")) { return sfnt::tag("SVG "); }
+    return tag;
+}
+
+std::vector<std::uint32_t>
+dropped(TableProfile const &profile, std::span<const std::uint32_t> const present) {
+    std::vector<std::uint32_t> res;
+    for (std::uint32_t const tag : present) {
+        if (not profile.keeps(tag)) { res.push_back(tag); }
+    }
+    return res;
+}
+
+bool
+drops_hinting(TableProfile const &profile) noexcept {
+    return not profile.keeps(sfnt::tag("fpgm")) || not profile.keeps(sfnt::tag("prep")) ||
+           not profile.keeps(sfnt::tag("cvt "));
+}
+
+void
+apply(otfcc_Font &font, TableProfile const &profile) {
+    for (otfcc_tag const tag : otfccTables) {
+        if (not profile.keeps(u(tag))) { otfcc_iFont.deleteTable(&font, u(tag)); }
+    }
+
+    if (font.name == nullptr || profile.nameIDs.empty()) { return; }
+    table_name &names = *font.name;
+    std::size_t w     = 0;
+    for (std::size_t i = 0; i < names.length; ++i) {
+        if (std::ranges::find(profile.nameIDs, names.items[i].nameID) != profile.nameIDs.end()) {
+            names.items[w++] = names.items[i];
+        }
+        else { sdsfree(names.items[i].nameString); }
+    }
+    names.length = w;
+}
+
+} // namespace table_profile
+} // namespace detail
+
+
+bool
+TableProfile::keeps(uint32_t tag) const noexcept {
+    tag = detail::table_profile::sfnt_tag(tag);
+    if (detail::table_profile::required(tag)) { return true; }
+    bool const listed = std::ranges::any_of(
+        tables, [&](uint32_t const t) { return detail::table_profile::sfnt_tag(t) == tag; });
+    return mode == Mode::keepListed ? listed : not listed;
+}
+
+TableProfile
+TableProfile::web_minimal() {
+    using otfcc_tag = otfcc_glyfTable_nameMapping;
+    TableProfile res;
+    res.mode    = Mode::keepListed;
+    res.tables  = {std::to_underlying(otfcc_tag::GSUB), std::to_underlying(otfcc_tag::GPOS),
+                   std::to_underlying(otfcc_tag::GDEF), std::to_underlying(otfcc_tag::COLR),
+                   std::to_underlying(otfcc_tag::CPAL), std::to_underlying(otfcc_tag::SVG),
+                   detail::sfnt::tag("CBDT"),           detail::sfnt::tag("CBLC"),
+                   detail::sfnt::tag("sbix")};
+    res.nameIDs = {1, 2, 3, 4, 5, 6};
+    return res;
+}
+
+TableProfile
+TableProfile::terminal() {
+    using otfcc_tag = otfcc_glyfTable_nameMapping;
+    TableProfile res;
+    res.mode    = Mode::keepListed;
+    res.tables  = {std::to_underlying(otfcc_tag::GSUB), std::to_underlying(otfcc_tag::GDEF)};
+    res.nameIDs = {1, 2, 4, 6};
+    return res;
+}
+
+TableProfile
+TableProfile::drop_unused() {
+    using otfcc_tag = otfcc_glyfTable_nameMapping;
+    TableProfile res;
+    res.mode   = Mode::dropListed;
+    res.tables = {std::to_underlying(otfcc_tag::LTSH), std::to_underlying(otfcc_tag::hdmx),
+                  std::to_underlying(otfcc_tag::meta), std::to_underlying(otfcc_tag::TSI0),
+                  std::to_underlying(otfcc_tag::TSI1), std::to_underlying(otfcc_tag::TSI2),
+                  std::to_underlying(otfcc_tag::TSI3), std::to_underlying(otfcc_tag::TSI5),
+                  detail::sfnt::tag("VDMX"),           detail::sfnt::tag("DSIG")};
+    return res;
+}
+
+} // namespace otfccxx
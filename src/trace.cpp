@@ -0,0 +1,111 @@
+#include <format>
+#include <functional>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+
+#include <otfccxx/otfccxx.hpp>
+
+#include <otfccxx_private/machinery_trace.hpp>
+
+
+namespace otfccxx {
+
+// #####################################################################
+// ### Trace sink installation ###
+// #####################################################################
+
+namespace detail {
+
+std::atomic<TraceSink *> g_traceSink{nullptr};
+
+void
+_traceScope::report() noexcept {
+    ev_.duration = std::chrono::steady_clock::now() - ev_.start;
+    ev_.threadID = std::hash<std::thread::id>{}(std::this_thread::get_id());
+    sink_->on_event(ev_);
+    sink_ = nullptr;
+}
+
+} // namespace detail
+
+void
+set_traceSink(TraceSink *sink) noexcept {
+    detail::g_traceSink.store(sink, std::memory_order_release);
+}
+TraceSink *
+get_traceSink() noexcept {
+    return detail::g_traceSink.load(std::memory_order_acquire);
+}
+
+
+// #####################################################################
+// ### ChromeTraceSink implementation ###
+// #####################################################################
+
+class ChromeTraceSink::Impl {
+public:
+    // Timestamps in the output are relative to the creation of the sink
+    std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+
+    mutable std::mutex      mtx;
+    std::vector<TraceEvent> events;
+};
+
+ChromeTraceSink::ChromeTraceSink() : pimpl(std::make_unique<Impl>()) {}
+ChromeTraceSink::~ChromeTraceSink() = default;
+
+void
+ChromeTraceSink::on_event(TraceEvent const &ev) noexcept {
+    try {
+        std::lock_guard lock(pimpl->mtx);
+        pimpl->events.push_back(ev);
+    }
+    catch (...) {
+        // Losing an event is preferable to failing the traced call
+    }
+}
+
+std::string
+ChromeTraceSink::to_json() const {
+    using us_d = std::chrono::duration<double, std::micro>;
+
+    std::lock_guard lock(pimpl->mtx);
+
+    // Thread hashes don't survive the trip through JavaScript numbers, the viewer gets small sequential ids instead
+    std::unordered_map<uint64_t, size_t> tids;
+    for (auto const &ev : pimpl->events) { tids.try_emplace(ev.threadID, tids.size() + 1); }
+
+    // 'Complete' events (ph: X), the viewer nests them by time on each thread
+    std::string res = "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    for (bool first = true; auto const &ev : pimpl->events) {
+        if (not first) { res += ','; }
+        first = false;
+        std::format_to(std::back_inserter(res),
+                       "\n{{\"name\": \"{}\", \"cat\": \"otfccxx\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, "
+                       "\"ts\": {:.3f}, \"dur\": {:.3f}, "
+                       "\"args\": {{\"bytesIn\": {}, \"bytesOut\": {}, \"glyphCount\": {}}}}}",
+                       ev.stage, tids.at(ev.threadID), us_d(ev.start - pimpl->origin).count(),
+                       us_d(ev.duration).count(), ev.bytesIn, ev.bytesOut, ev.glyphCount);
+    }
+    res += "\n]}\n";
+    return res;
+}
+
+std::expected<size_t, err_write>
+ChromeTraceSink::write_toFile(std::filesystem::path const &p) const {
+    std::string const json = to_json();
+    return write_bytesToFile_atomic(p, std::as_bytes(std::span(json)));
+}
+
+void
+ChromeTraceSink::clear() noexcept {
+    std::lock_guard lock(pimpl->mtx);
+    pimpl->events.clear();
+}
+
+} // namespace otfccxx
@@ -0,0 +1,553 @@
+#include <algorithm>
+#include <cstring>
+
+#include <otfccxx_private/utf_simd.hpp>
+
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define OTFCCXX_UTF_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && ! defined(__clang__)
+#include <intrin.h>
+#define OTFCCXX_UTF_TARGET(x)
+#else
+#define OTFCCXX_UTF_TARGET(x) __attribute__((target(x)))
+#endif
+#endif
+
+
+namespace otfccxx {
+namespace detail {
+namespace utf {
+
+namespace {
+
+inline void
+set_bit(std::uint64_t *bitmap, std::uint32_t cp) noexcept {
+    bitmap[cp >> 6] |= std::uint64_t{1} << (cp & 63);
+}
+
+inline bool
+is_highSurrogate(char16_t u) noexcept {
+    return (u & 0xFC00) == 0xD800;
+}
+inline bool
+is_lowSurrogate(char16_t u) noexcept {
+    return (u & 0xFC00) == 0xDC00;
+}
+
+
+// -------------------------------------------------
+// Scalar
+// -------------------------------------------------
+
+// Length of the UTF-8 sequence started by 'lead', 0 for bytes that can't start one
+constexpr std::size_t
+seq_length(std::uint8_t lead) noexcept {
+    if (lead < 0x80) { return 1; }
+    if (lead < 0xC2) { return 0; } // Continuation bytes and overlong 2 byte leads
+    if (lead < 0xE0) { return 2; }
+    if (lead < 0xF0) { return 3; }
+    if (lead < 0xF5) { return 4; }
+    return 0;
+}
+
+// Decodes one complete sequence of 'len' (== seq_length(s[0])) bytes. The range of the second byte is what rules out
+// overlong forms, surrogates and codepoints above U+10FFFF.
+bool
+decode_seq(const std::uint8_t *s, std::size_t len, std::uint32_t &cp) noexcept {
+    auto const isCont = [](std::uint8_t b) { return (b & 0xC0) == 0x80; };
+    switch (len) {
+        case 1: cp = s[0]; return true;
+        case 2:
+            if (not isCont(s[1])) { return false; }
+            cp = ((s[0] & 0x1Fu) << 6) | (s[1] & 0x3Fu);
+            return true;
+        case 3: {
+            std::uint8_t const lo = s[0] == 0xE0 ? 0xA0 : 0x80;
+            std::uint8_t const hi = s[0] == 0xED ? 0x9F : 0xBF;
+            if (s[1] < lo || s[1] > hi || not isCont(s[2])) { return false; }
+            cp = ((s[0] & 0x0Fu) << 12) | ((s[1] & 0x3Fu) << 6) | (s[2] & 0x3Fu);
+            return true;
+        }
+        case 4: {
+            std::uint8_t const lo = s[0] == 0xF0 ? 0x90 : 0x80;
+            std::uint8_t const hi = s[0] == 0xF4 ? 0x8F : 0xBF;
+            if (s[1] < lo || s[1] > hi || not isCont(s[2]) || not isCont(s[3])) { return false; }
+            cp = ((s[0] & 0x07u) << 18) | ((s[1] & 0x3Fu) << 12) | ((s[2] & 0x3Fu) << 6) | (s[3] & 0x3Fu);
+            return true;
+        }
+        default: return false;
+    }
+}
+
+// All of ASCII lands in the first two words of the bitmap
+void
+mark_ascii(const std::uint8_t *src, std::size_t n, std::uint64_t *bitmap) noexcept {
+    std::uint64_t acc[2]{};
+    for (std::size_t i = 0; i < n; ++i) { acc[src[i] >> 6] |= std::uint64_t{1} << (src[i] & 63); }
+    bitmap[0] |= acc[0];
+    bitmap[1] |= acc[1];
+}
+
+// Non-surrogate code units are codepoints as they are
+void
+mark_bmp(const char16_t *src, std::size_t n, std::uint64_t *bitmap) noexcept {
+    for (std::size_t i = 0; i < n; ++i) { set_bit(bitmap, src[i]); }
+}
+
+// Length of the leading ASCII only part (checked 8 bytes at a time)
+std::size_t
+asciiRun_scalar(const std::uint8_t *src, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, src + i, 8);
+        if (word & 0x8080808080808080ull) { break; }
+    }
+    return i;
+}
+
+// Length of the leading part without surrogates
+std::size_t
+bmpRun_scalar(const char16_t *src, std::size_t n) noexcept {
+    std::size_t i = 0;
+    while (i < n && (src[i] & 0xF800) != 0xD800) { ++i; }
+    return i;
+}
+
+
+#if defined(OTFCCXX_UTF_X86)
+// -------------------------------------------------
+// SSE2 (16 bytes, 8 code units)
+// -------------------------------------------------
+OTFCCXX_UTF_TARGET("sse2") std::size_t
+asciiRun_sse2(const std::uint8_t *src, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))) != 0) { break; }
+    }
+    return i + asciiRun_scalar(src + i, n - i);
+}
+
+OTFCCXX_UTF_TARGET("sse2") std::size_t
+bmpRun_sse2(const char16_t *src, std::size_t n) noexcept {
+    __m128i const maskF800 = _mm_set1_epi16(static_cast<short>(0xF800));
+    __m128i const valD800  = _mm_set1_epi16(static_cast<short>(0xD800));
+
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i const units = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, maskF800), valD800)) != 0) { break; }
+    }
+    return i + bmpRun_scalar(src + i, n - i);
+}
+
+// 8 two byte sequences from 16 bytes into 'cps'. False (and 'cps' undefined) unless all of them are valid, the scalar
+// decoder then takes over and finds out what they are.
+OTFCCXX_UTF_TARGET("sse2") bool
+decode2_sse2(const std::uint8_t *src, std::uint32_t *cps) noexcept {
+    // Lead in the low byte of every 16 bit lane, continuation in the high one
+    __m128i const units  = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    __m128i const tagsOK = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xC0E0))),
+                                           _mm_set1_epi16(static_cast<short>(0x80C0)));
+    // C0 and C1 leads only make overlong forms
+    __m128i const overlong = _mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(0x1E)), _mm_setzero_si128());
+    if (_mm_movemask_epi8(_mm_andnot_si128(overlong, tagsOK)) != 0xFFFF) { return false; }
+
+    __m128i const cp = _mm_or_si128(_mm_slli_epi16(_mm_and_si128(units, _mm_set1_epi16(0x1F)), 6),
+                                    _mm_and_si128(_mm_srli_epi16(units, 8), _mm_set1_epi16(0x3F)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(cps), _mm_unpacklo_epi16(cp, _mm_setzero_si128()));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(cps + 4), _mm_unpackhi_epi16(cp, _mm_setzero_si128()));
+    return true;
+}
+
+// Three byte sequences gathered into 32 bit lanes as 'lead << 16 | second << 8 | third'. All of them valid means
+// no overlong forms and no surrogates.
+OTFCCXX_UTF_TARGET("sse2") inline __m128i
+decode3_lanes(__m128i const lanes, bool &valid) noexcept {
+    __m128i const tagsOK = _mm_cmpeq_epi32(_mm_and_si128(lanes, _mm_set1_epi32(0xF0C0C0)), _mm_set1_epi32(0xE08080));
+    __m128i const cp =
+        _mm_or_si128(_mm_or_si128(_mm_and_si128(_mm_srli_epi32(lanes, 4), _mm_set1_epi32(0xF000)),
+                                  _mm_and_si128(_mm_srli_epi32(lanes, 2), _mm_set1_epi32(0x0FC0))),
+                     _mm_and_si128(lanes, _mm_set1_epi32(0x3F)));
+    __m128i const overlong  = _mm_cmplt_epi32(cp, _mm_set1_epi32(0x800));
+    __m128i const surrogate = _mm_cmpeq_epi32(_mm_and_si128(cp, _mm_set1_epi32(0xF800)), _mm_set1_epi32(0xD800));
+    valid = _mm_movemask_epi8(_mm_andnot_si128(_mm_or_si128(overlong, surrogate), tagsOK)) == 0xFFFF;
+    return cp;
+}
+
+// 4 three byte sequences from 12 bytes (16 are read) into 'cps', same contract as decode2_sse2()
+OTFCCXX_UTF_TARGET("ssse3") bool
+decode3_ssse3(const std::uint8_t *src, std::uint32_t *cps) noexcept {
+    __m128i const gather = _mm_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    bool          valid;
+    __m128i const cp =
+        decode3_lanes(_mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src)), gather), valid);
+    if (not valid) { return false; }
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(cps), cp);
+    return true;
+}
+
+
+// -------------------------------------------------
+// AVX2 (32 bytes, 16 code units)
+// -------------------------------------------------
+OTFCCXX_UTF_TARGET("avx2") std::size_t
+asciiRun_avx2(const std::uint8_t *src, std::size_t n) noexcept {
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i))) != 0) { break; }
+    }
+    return i + asciiRun_sse2(src + i, n - i);
+}
+
+OTFCCXX_UTF_TARGET("avx2") std::size_t
+bmpRun_avx2(const char16_t *src, std::size_t n) noexcept {
+    __m256i const maskF800 = _mm256_set1_epi16(static_cast<short>(0xF800));
+    __m256i const valD800  = _mm256_set1_epi16(static_cast<short>(0xD800));
+
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i const units = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_and_si256(units, maskF800), valD800)) != 0) { break; }
+    }
+    return i + bmpRun_sse2(src + i, n - i);
+}
+
+// 16 two byte sequences from 32 bytes, same as decode2_sse2()
+OTFCCXX_UTF_TARGET("avx2") bool
+decode2_avx2(const std::uint8_t *src, std::uint32_t *cps) noexcept {
+    __m256i const units  = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+    __m256i const tagsOK = _mm256_cmpeq_epi16(_mm256_and_si256(units, _mm256_set1_epi16(static_cast<short>(0xC0E0))),
+                                              _mm256_set1_epi16(static_cast<short>(0x80C0)));
+    __m256i const overlong =
+        _mm256_cmpeq_epi16(_mm256_and_si256(units, _mm256_set1_epi16(0x1E)), _mm256_setzero_si256());
+    if (_mm256_movemask_epi8(_mm256_andnot_si256(overlong, tagsOK)) != -1) { return false; }
+
+    __m256i const cp = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(units, _mm256_set1_epi16(0x1F)), 6),
+                                       _mm256_and_si256(_mm256_srli_epi16(units, 8), _mm256_set1_epi16(0x3F)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(cps), _mm256_cvtepu16_epi32(_mm256_castsi256_si128(cp)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(cps + 8), _mm256_cvtepu16_epi32(_mm256_extracti128_si256(cp, 1)));
+    return true;
+}
+
+// 8 three byte sequences from 24 bytes (28 are read), each 128 bit lane gathers 12 of them
+OTFCCXX_UTF_TARGET("avx2") bool
+decode3_avx2(const std::uint8_t *src, std::uint32_t *cps) noexcept {
+    __m256i const gather = _mm256_setr_epi8(2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1, //
+                                            2, 1, 0, -1, 5, 4, 3, -1, 8, 7, 6, -1, 11, 10, 9, -1);
+    __m256i const bytes  = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 12)), 1);
+    __m256i const lanes  = _mm256_shuffle_epi8(bytes, gather);
+
+    __m256i const tagsOK =
+        _mm256_cmpeq_epi32(_mm256_and_si256(lanes, _mm256_set1_epi32(0xF0C0C0)), _mm256_set1_epi32(0xE08080));
+    __m256i const cp = _mm256_or_si256(
+        _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(lanes, 4), _mm256_set1_epi32(0xF000)),
+                        _mm256_and_si256(_mm256_srli_epi32(lanes, 2), _mm256_set1_epi32(0x0FC0))),
+        _mm256_and_si256(lanes, _mm256_set1_epi32(0x3F)));
+    __m256i const overlong  = _mm256_cmpgt_epi32(_mm256_set1_epi32(0x800), cp);
+    __m256i const surrogate = _mm256_cmpeq_epi32(_mm256_and_si256(cp, _mm256_set1_epi32(0xF800)),
+                                                 _mm256_set1_epi32(0xD800));
+    if (_mm256_movemask_epi8(_mm256_andnot_si256(_mm256_or_si256(overlong, surrogate), tagsOK)) != -1) {
+        return false;
+    }
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(cps), cp);
+    return true;
+}
+
+
+// -------------------------------------------------
+// Runtime dispatch
+// -------------------------------------------------
+enum class variant {
+    scalar,
+    sse2,
+    ssse3,
+    avx2
+};
+
+variant
+detect_variant() noexcept {
+#if defined(_MSC_VER) && ! defined(__clang__)
+    int regs[4]{};
+    __cpuid(regs, 0);
+    int const maxLeaf = regs[0];
+    if (maxLeaf < 1) { return variant::scalar; }
+
+    __cpuid(regs, 1);
+    bool const has_sse2   = (regs[3] & (1 << 26)) != 0;
+    bool const has_ssse3  = (regs[2] & (1 << 9)) != 0;
+    bool const has_osxsav = (regs[2] & (1 << 27)) != 0;
+    bool const has_avx    = (regs[2] & (1 << 28)) != 0;
+
+    bool has_avx2 = false;
+    if (maxLeaf >= 7 && has_osxsav && has_avx && (_xgetbv(0) & 0x6) == 0x6) {
+        __cpuidex(regs, 7, 0);
+        has_avx2 = (regs[1] & (1 << 5)) != 0;
+    }
+    if (has_avx2) { return variant::avx2; }
+    if (has_ssse3) { return variant::ssse3; }
+    if (has_sse2) { return variant::sse2; }
+    return variant::scalar;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) { return variant::avx2; }
+    if (__builtin_cpu_supports("ssse3")) { return variant::ssse3; }
+    if (__builtin_cpu_supports("sse2")) { return variant::sse2; }
+    return variant::scalar;
+#endif
+}
+
+variant
+active() noexcept {
+    static variant const res = detect_variant();
+    return res;
+}
+#endif
+
+std::size_t
+ascii_run(const std::uint8_t *src, std::size_t n) noexcept {
+#if defined(OTFCCXX_UTF_X86)
+    switch (active()) {
+        case variant::avx2:  return asciiRun_avx2(src, n);
+        case variant::ssse3:
+        case variant::sse2:  return asciiRun_sse2(src, n);
+        default:             break;
+    }
+#endif
+    return asciiRun_scalar(src, n);
+}
+
+std::size_t
+bmp_run(const char16_t *src, std::size_t n) noexcept {
+#if defined(OTFCCXX_UTF_X86)
+    switch (active()) {
+        case variant::avx2:  return bmpRun_avx2(src, n);
+        case variant::ssse3:
+        case variant::sse2:  return bmpRun_sse2(src, n);
+        default:             break;
+    }
+#endif
+    return bmpRun_scalar(src, n);
+}
+
+// Bytes the block decoders may read at once
+constexpr std::size_t blockReach = 32;
+
+// Decodes a block of 'len' byte sequences (2 or 3) into 'cps' (room for 16), when all of them are valid. Returns the
+// number of codepoints, 0 when there is no such variant or the block isn't only made of valid 'len' byte sequences.
+// Needs 'blockReach' readable bytes at 'src'.
+std::size_t
+decode_block(const std::uint8_t *src, std::size_t len, std::uint32_t *cps) noexcept {
+#if defined(OTFCCXX_UTF_X86)
+    switch (active()) {
+        case variant::avx2:
+            if (len == 2) { return decode2_avx2(src, cps) ? 16 : 0; }
+            return decode3_avx2(src, cps) ? 8 : 0;
+        case variant::ssse3:
+            if (len == 2) { return decode2_sse2(src, cps) ? 8 : 0; }
+            return decode3_ssse3(src, cps) ? 4 : 0;
+        case variant::sse2:
+            if (len == 2) { return decode2_sse2(src, cps) ? 8 : 0; }
+            break;
+        default: break;
+    }
+#else
+    (void)src;
+    (void)len;
+    (void)cps;
+#endif
+    return 0;
+}
+
+} // namespace
+
+
+// -------------------------------------------------
+// UTF-8
+// -------------------------------------------------
+void
+utf8_decoder::emit(std::uint32_t cp, std::uint64_t *bitmap) noexcept {
+    if (atStart_) {
+        atStart_ = false;
+        if (cp == 0xFEFF) { return; }
+    }
+    set_bit(bitmap, cp);
+}
+
+bool
+utf8_decoder::feed(const std::uint8_t *src, std::size_t n, std::uint64_t *bitmap) noexcept {
+    std::size_t i = 0;
+
+    // Complete the sequence carried over from the previous chunk first
+    if (carryLen_ > 0) {
+        std::size_t const len  = seq_length(carry_[0]);
+        std::size_t const take = std::min(len - carryLen_, n);
+        std::copy_n(src, take, carry_.begin() + carryLen_);
+        carryLen_ += take;
+        i          = take;
+        if (carryLen_ < len) { return true; }
+
+        std::uint32_t cp;
+        carryLen_ = 0;
+        if (not decode_seq(carry_.data(), len, cp)) {
+            reset();
+            return false;
+        }
+        emit(cp, bitmap);
+    }
+
+    while (i < n) {
+        if (std::size_t const run = ascii_run(src + i, n - i); run > 0) {
+            atStart_ = false; // No byte order mark in ASCII
+            mark_ascii(src + i, run, bitmap);
+            i += run;
+            if (i == n) { break; }
+        }
+
+        // Blocks of 2 or 3 byte sequences (eg. Cyrillic, Greek, Arabic or CJK text) are validated and decoded in SIMD,
+        // everything else one sequence at a time up to the next ASCII byte. After a block that doesn't decode, its
+        // bytes go through the scalar path before the next attempt.
+        std::size_t scalarUntil = i;
+        do {
+            std::size_t const len = seq_length(src[i]);
+            if (len == 0) {
+                reset();
+                return false;
+            }
+            if ((len == 2 || len == 3) && i >= scalarUntil && n - i >= blockReach) {
+                std::uint32_t cps[16];
+                if (std::size_t const count = decode_block(src + i, len, cps); count > 0) {
+                    // The bitmap writes are scattered, no SIMD for those
+                    for (std::size_t k = 0; k < count; ++k) { emit(cps[k], bitmap); }
+                    i += count * len;
+                    continue;
+                }
+                scalarUntil = i + blockReach;
+            }
+            if (n - i < len) {
+                // Incomplete sequence at the end of the chunk, validated once the rest of it arrives
+                carryLen_ = n - i;
+                std::copy_n(src + i, carryLen_, carry_.begin());
+                return true;
+            }
+
+            std::uint32_t cp;
+            if (not decode_seq(src + i, len, cp)) {
+                reset();
+                return false;
+            }
+            emit(cp, bitmap);
+            i += len;
+        } while (i < n && src[i] >= 0x80);
+    }
+    return true;
+}
+
+bool
+utf8_decoder::finish() noexcept {
+    bool const res = (carryLen_ == 0);
+    reset();
+    return res;
+}
+
+void
+utf8_decoder::reset() noexcept {
+    carryLen_ = 0;
+    atStart_  = true;
+}
+
+
+// -------------------------------------------------
+// UTF-16
+// -------------------------------------------------
+void
+utf16_decoder::emit(std::uint32_t cp, std::uint64_t *bitmap) noexcept {
+    if (atStart_) {
+        atStart_ = false;
+        if (cp == 0xFEFF) { return; }
+    }
+    set_bit(bitmap, cp);
+}
+
+bool
+utf16_decoder::feed(const char16_t *src, std::size_t n, std::uint64_t *bitmap) noexcept {
+    std::size_t i = 0;
+
+    // High surrogate carried over from the previous chunk
+    if (pendingHigh_ != 0 && n > 0) {
+        if (not is_lowSurrogate(src[0])) {
+            reset();
+            return false;
+        }
+        emit(0x10000 + ((std::uint32_t{pendingHigh_} - 0xD800) << 10) + (src[0] - 0xDC00), bitmap);
+        pendingHigh_ = 0;
+        i            = 1;
+    }
+
+    while (i < n) {
+        if (std::size_t run = bmp_run(src + i, n - i); run > 0) {
+            if (atStart_) {
+                emit(src[i], bitmap);
+                ++i;
+                --run;
+            }
+            mark_bmp(src + i, run, bitmap);
+            i += run;
+            if (i == n) { break; }
+        }
+
+        // Surrogate pair
+        char16_t const hi = src[i];
+        if (not is_highSurrogate(hi)) {
+            reset();
+            return false;
+        }
+        if (i + 1 == n) {
+            pendingHigh_ = hi;
+            return true;
+        }
+        char16_t const lo = src[i + 1];
+        if (not is_lowSurrogate(lo)) {
+            reset();
+            return false;
+        }
+        emit(0x10000 + ((std::uint32_t{hi} - 0xD800) << 10) + (lo - 0xDC00u), bitmap);
+        i += 2;
+    }
+    return true;
+}
+
+bool
+utf16_decoder::finish() noexcept {
+    bool const res = (pendingHigh_ == 0);
+    reset();
+    return res;
+}
+
+void
+utf16_decoder::reset() noexcept {
+    pendingHigh_ = 0;
+    atStart_     = true;
+}
+
+
+const char *
+active_variant() noexcept {
+#if defined(OTFCCXX_UTF_X86)
+    switch (active()) {
+        case variant::avx2:  return "avx2";
+        case variant::ssse3: return "ssse3";
+        case variant::sse2:  return "sse2";
+        default:             break;
+    }
+#endif
+    return "scalar";
+}
+
+} // namespace utf
+} // namespace detail
+} // namespace otfccxx
@@ -0,0 +1,304 @@
+// Behavioral checks of otfccxx's public API, run by CTest.
+//
+// Usage: otfccxx_tests [<filter substring>]
+//
+// Every font is generated by otfccxx::FontSynthesizer, so the checks need no font files. Each failed check is reported
+// with its line, the exit code is 1 when any check failed.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <source_location>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <otfccxx/otfccxx.hpp>
+
+
+namespace {
+using namespace std::literals;
+
+class Checks {
+public:
+    void
+    check(bool const ok, std::string_view const what,
+          std::source_location const loc = std::source_location::current()) {
+        ++count_;
+        if (ok) { return; }
+        ++failed_;
+        std::cerr << "[otfccxx_tests] " << current_ << ": line " << loc.line() << ": " << what << '\n';
+    }
+
+    void
+    run(std::string_view const name, std::string_view const filter, std::function<void(Checks &)> const &fn) {
+        if (not filter.empty() && name.find(filter) == std::string_view::npos) { return; }
+        current_ = name;
+        std::cerr << "[otfccxx_tests] " << name << '\n';
+        fn(*this);
+    }
+
+    size_t
+    count() const noexcept {
+        return count_;
+    }
+    size_t
+    failed() const noexcept {
+        return failed_;
+    }
+
+private:
+    std::string_view current_;
+    size_t           count_  = 0;
+    size_t           failed_ = 0;
+};
+
+
+// #####################################################################
+// ### Inputs ###
+// #####################################################################
+
+constexpr uint32_t
+tag(char const (&s)[5]) noexcept {
+    return (uint32_t(uint8_t(s[0])) << 24) | (uint32_t(uint8_t(s[1])) << 16) | (uint32_t(uint8_t(s[2])) << 8) |
+           uint32_t(uint8_t(s[3]));
+}
+
+// Big endian uint16 at 'offset' of table 'tableTag' in 'font'
+std::optional<uint16_t>
+read_u16(otfccxx::ByteSpan const font, uint32_t const tableTag, size_t const offset) {
+    auto exp_src = otfccxx::FontSource::from_bytes(font);
+    if (not exp_src.has_value()) { return std::nullopt; }
+    auto const rec = exp_src->find_table(tableTag);
+    if (not rec.has_value() || rec->length < offset + 2 || rec->offset + offset + 2 > font.size()) {
+        return std::nullopt;
+    }
+    auto const *p = font.data() + rec->offset + offset;
+    return static_cast<uint16_t>((std::to_integer<uint16_t>(p[0]) << 8) | std::to_integer<uint16_t>(p[1]));
+}
+
+// Glyphs 1 .. 95 mapped from U+0020 .. U+007E, no composites
+otfccxx::SyntheticFontSpec
+spec_ascii() {
+    otfccxx::SyntheticFontSpec spec;
+    spec.glyphCount     = 96;
+    spec.compositeDepth = 0;
+    spec.cmapRanges     = {{0x20, 0x7E}};
+    return spec;
+}
+
+otfccxx::Bytes
+synth(otfccxx::SyntheticFontSpec const &spec) {
+    auto exp_bytes = otfccxx::FontSynthesizer::generate(spec);
+    return exp_bytes.has_value() ? std::move(exp_bytes.value()) : otfccxx::Bytes{};
+}
+
+
+// #####################################################################
+// ### Checks ###
+// #####################################################################
+
+void
+test_base64(Checks &t) {
+    otfccxx::Bytes data(1000);
+    for (size_t i = 0; i < data.size(); ++i) { data[i] = static_cast<std::byte>(i * 7 + 3); }
+
+    auto const exp_enc = otfccxx::Converter::encode_base64(data);
+    t.check(exp_enc.has_value(), "encode_base64");
+    if (not exp_enc.has_value()) { return; }
+    t.check(exp_enc->size() == otfccxx::Converter::base64_encodedSize(data.size()), "encoded size");
+
+    auto const exp_dec = otfccxx::Converter::decode_base64(exp_enc.value());
+    t.check(exp_dec.has_value() && exp_dec.value() == data, "decode_base64 round trip");
+
+    // Chunked, with chunks that split the 3 byte groups
+    otfccxx::Base64Encoder enc;
+    std::string            chunked;
+    for (size_t i = 0; i < data.size(); i += 77) {
+        auto const chunk = std::span(data).subspan(i, std::min<size_t>(77, data.size() - i));
+        t.check(enc.feed(chunk, chunked).has_value(), "Base64Encoder::feed");
+    }
+    t.check(enc.finish(chunked).has_value(), "Base64Encoder::finish");
+    t.check(chunked == exp_enc.value(), "chunked encoding equals encode_base64");
+
+    t.check(not otfccxx::Converter::decode_base64("abc"sv).has_value(), "length not a multiple of 4 is rejected");
+    t.check(not otfccxx::Converter::decode_base64("ab!d"sv).has_value(), "invalid char is rejected");
+
+    auto const exp_uri = otfccxx::Converter::encode_dataURI(data, "font/ttf"sv);
+    t.check(exp_uri.has_value() && exp_uri->starts_with("data:font/ttf;base64,"sv) &&
+                exp_uri->ends_with(exp_enc.value()),
+            "encode_dataURI");
+}
+
+void
+test_fontSource(Checks &t) {
+    auto const font = synth(spec_ascii());
+    t.check(not font.empty(), "FontSynthesizer::generate");
+
+    auto exp_src = otfccxx::FontSource::from_bytes(font);
+    t.check(exp_src.has_value(), "FontSource::from_bytes");
+    if (not exp_src.has_value()) { return; }
+    t.check(exp_src->face_count() == 1, "one face");
+    t.check(exp_src->find_table(tag("glyf")).has_value() && exp_src->find_table(tag("cmap")).has_value(),
+            "glyf and cmap present");
+    t.check(exp_src->table_directory(1).empty(), "face index out of range");
+    t.check(read_u16(font, tag("maxp"), 4) == uint16_t{96}, "numGlyphs as specified");
+
+    auto const exp_copy = otfccxx::FontSource::from_bytes(font);
+    t.check(exp_copy.has_value() && exp_copy->fingerprint() == exp_src->fingerprint(), "fingerprint of equal data");
+
+    otfccxx::Bytes const garbage(64, std::byte{0x42});
+    t.check(not otfccxx::FontSource::from_bytes(garbage).has_value(), "garbage is not an SFNT");
+}
+
+void
+test_subsetText(Checks &t) {
+    auto const font = synth(spec_ascii());
+
+    otfccxx::Subsetter whole;
+    whole.add_ff_toSubset(font).add_toKeep_text("Hello \xC3\xA9"sv);
+    auto const exp_whole = whole.execute_bestEffort();
+    t.check(exp_whole.has_value(), "execute_bestEffort");
+    if (not exp_whole.has_value()) { return; }
+    t.check(exp_whole->first.size() == 1, "one subset");
+    t.check(exp_whole->second == std::vector<uint32_t>{0xE9}, "U+00E9 reported missing");
+
+    // Same text in chunks of 7 bytes (the first ends inside the 2 byte sequence) gives the same subset
+    std::string_view const text = "Hello \xC3\xA9"sv;
+    otfccxx::Subsetter     chunks;
+    chunks.add_ff_toSubset(font);
+    for (size_t i = 0; i < text.size(); i += 7) { chunks.add_toKeep_textChunk(text.substr(i, 7)); }
+    chunks.finish_text();
+    auto const exp_chunks = chunks.execute_bestEffort();
+    t.check(exp_chunks.has_value() && exp_chunks->first == exp_whole->first, "chunked text gives the same subset");
+
+    otfccxx::Subsetter invalid;
+    invalid.add_ff_toSubset(font).add_toKeep_text("ok \xC3"sv);
+    t.check(invalid.is_inError() && invalid.get_error() == otfccxx::err_subset::text_invalidUTF8,
+            "truncated UTF-8 puts the Subsetter in error");
+}
+
+void
+test_subsetDelta(Checks &t) {
+    auto const font = synth(spec_ascii());
+
+    // What the client holds: U+0020 .. U+004F with the original glyph IDs
+    otfccxx::CPRange const held{0x20, 0x4F};
+    otfccxx::Subsetter     prev;
+    prev.add_ff_toSubset(font).set_retainGlyphIDs(true).add_toKeep_CPRange(held.first, held.last);
+    auto const exp_prev = prev.execute();
+    t.check(exp_prev.has_value() && exp_prev->size() == 1, "previous subset");
+    if (not exp_prev.has_value() || exp_prev->size() != 1) { return; }
+
+    otfccxx::Subsetter next;
+    next.add_ff_toSubset(font).add_toKeep_CPRange(0x50, 0x7E);
+    auto const exp_delta = next.execute_delta(std::span(&held, 1));
+    t.check(exp_delta.has_value() && exp_delta->size() == 1, "execute_delta");
+    if (not exp_delta.has_value() || exp_delta->size() != 1) { return; }
+
+    auto const &dlt = exp_delta->front();
+    t.check(not dlt.isNewFace && dlt.previousBytes == exp_prev->front().size(), "delta made against the held subset");
+    auto const exp_applied = otfccxx::Converter::apply_subsetPatch(exp_prev->front(), dlt.patch);
+    t.check(exp_applied.has_value() && exp_applied.value() == dlt.font, "patch rebuilds the extended subset");
+
+    auto const exp_wrongBase = otfccxx::Converter::apply_subsetPatch(dlt.font, dlt.patch);
+    t.check(not exp_wrongBase.has_value() &&
+                exp_wrongBase.error() == otfccxx::err_converter::patch_baseMismatch,
+            "patch rejects another base");
+}
+
+void
+test_modifier(Checks &t) {
+    auto const font = synth(spec_ascii());
+
+    auto exp_bad = otfccxx::Modifier::create(otfccxx::Bytes(64, std::byte{0x42}));
+    t.check(not exp_bad.has_value(), "create() reports an unreadable font");
+
+    auto exp_modi = otfccxx::Modifier::create(font);
+    t.check(exp_modi.has_value(), "Modifier::create");
+    if (not exp_modi.has_value()) { return; }
+
+    auto exp_clone = exp_modi->clone();
+    t.check(exp_clone.has_value(), "clone");
+
+    t.check(exp_modi->change_unitsPerEm(2048).has_value(), "change_unitsPerEm");
+    auto const exp_scaled = exp_modi->exportResult();
+    t.check(exp_scaled.has_value() && read_u16(exp_scaled.value(), tag("head"), 18) == uint16_t{2048},
+            "exported unitsPerEm");
+
+    // The clone was taken before the change
+    if (exp_clone.has_value()) {
+        auto const exp_orig = exp_clone->exportResult();
+        t.check(exp_orig.has_value() && read_u16(exp_orig.value(), tag("head"), 18) == uint16_t{1000},
+                "clone is independent");
+    }
+
+    auto exp_kept = otfccxx::Modifier::create(font);
+    if (not exp_kept.has_value()) { return; }
+    std::vector<uint32_t> const cps{'A', 'B'};
+    auto const                  exp_count = exp_kept->keep_glyphsForCPs(cps);
+    t.check(exp_count.has_value() && exp_count.value() == 3, "keep_glyphsForCPs keeps .notdef, A and B");
+    auto const exp_small = exp_kept->exportResult();
+    t.check(exp_small.has_value() && read_u16(exp_small.value(), tag("maxp"), 4) == uint16_t{3}, "numGlyphs after");
+}
+
+void
+test_modifierRoundTrips(Checks &t) {
+    auto const font = synth(spec_ascii());
+    auto       exp_src = otfccxx::FontSource::from_bytes(font);
+    t.check(exp_src.has_value(), "FontSource::from_bytes");
+    if (not exp_src.has_value()) { return; }
+    otfccxx::Modifier modi(exp_src.value());
+
+    auto const exp_json = modi.export_json();
+    t.check(exp_json.has_value() && exp_json->starts_with("{"sv), "export_json");
+    if (exp_json.has_value()) {
+        auto exp_back = otfccxx::Modifier::from_json(exp_json.value());
+        t.check(exp_back.has_value(), "from_json");
+        if (exp_back.has_value()) {
+            auto const exp_res = exp_back->exportResult();
+            t.check(exp_res.has_value() && read_u16(exp_res.value(), tag("maxp"), 4) == uint16_t{96},
+                    "JSON round trip keeps the glyphs");
+        }
+    }
+    t.check(not otfccxx::Modifier::from_json("{\"glyf\": ["sv).has_value(), "truncated JSON is rejected");
+
+    auto const exp_snap = modi.save_snapshot();
+    t.check(exp_snap.has_value(), "save_snapshot");
+    if (not exp_snap.has_value()) { return; }
+    auto exp_loaded = otfccxx::Modifier::from_snapshot(exp_snap.value(), exp_src->fingerprint());
+    t.check(exp_loaded.has_value() && exp_loaded->exportResult().has_value(), "from_snapshot");
+
+    auto const exp_stale = otfccxx::Modifier::from_snapshot(exp_snap.value(), exp_src->fingerprint() + 1);
+    t.check(not exp_stale.has_value() && exp_stale.error() == otfccxx::err_modifier::snapshot_stale,
+            "snapshot of another font is stale");
+
+    otfccxx::Bytes corrupt = exp_snap.value();
+    corrupt.back() ^= std::byte{0xFF};
+    auto const exp_corrupt = otfccxx::Modifier::from_snapshot(corrupt);
+    t.check(not exp_corrupt.has_value() && exp_corrupt.error() == otfccxx::err_modifier::snapshot_invalid,
+            "corrupted snapshot is invalid");
+}
+
+} // namespace
+
+
+int
+main(int argc, char *argv[]) {
+    std::string_view const filter = argc > 1 ? std::string_view(argv[1]) : std::string_view{};
+
+    Checks t;
+    t.run("base64"sv, filter, test_base64);
+    t.run("fontSource"sv, filter, test_fontSource);
+    t.run("subsetter.text"sv, filter, test_subsetText);
+    t.run("subsetter.delta"sv, filter, test_subsetDelta);
+    t.run("modifier"sv, filter, test_modifier);
+    t.run("modifier.roundTrips"sv, filter, test_modifierRoundTrips);
+
+    std::cerr << "[otfccxx_tests] " << t.count() - t.failed() << " of " << t.count() << " checks passed\n";
+    return t.failed() == 0 ? 0 : 1;
+}